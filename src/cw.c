@@ -17,14 +17,10 @@
 #include "pannel.h"
 #include "meter.h"
 #include "fpga/adc.h"
+#include "dsp/order.h"
 #include "settings/modes.h"
 #include "settings/options.h"
 
-typedef struct {
-    uint16_t    n;
-    float       db;
-} fft_item_t;
-
 #define FFT             256
 #define OVER            4
 #define FFT_OVER        (FFT / OVER)
@@ -35,7 +31,7 @@ static pthread_cond_t   cond;
 
 static bool             ready = false;
 
-static fft_item_t       fft_items[FFT / 2];
+static float            peak_work[FFT / 2];
 
 static cbuffercf        audio_buf;
 static spgramcf         audio_sg;
@@ -73,45 +69,31 @@ void cw_init() {
     ready = true;
 }
 
-static int compare_fft_items(const void *p1, const void *p2) {
-    fft_item_t *i1 = (fft_item_t *) p1;
-    fft_item_t *i2 = (fft_item_t *) p2;
-
-    return (i1->db > i2->db) ? -1 : 1;
-}
-
 static bool cw_get_peak() {
     uint32_t    start = FFT / 2 + FFT * op_mode->filter.low / ADC_RATE;
     uint32_t    stop = FFT / 2 + FFT * op_mode->filter.high / ADC_RATE;
-    uint16_t    num = stop - start;
 
     float       peak_db = 0;
     uint16_t    peak_n = 0;
     float       noise_db = 0;
-    bool        find = true;
-    uint16_t    item = 0;
+    uint16_t    peak_width = 2;
 
-    for (uint16_t n = start; n < stop; n++) {
-        fft_items[item].n = n;
-        fft_items[item].db = audio_psd_sum[n];
+    /* A narrow or inverted filter from the settings leaves no noise bins to compare with */
 
-        item++;
+    if (stop > FFT) {
+        stop = FFT;
     }
 
-    qsort(&fft_items, num, sizeof(fft_item_t), compare_fft_items);
+    if (stop <= start + peak_width) {
+        peak_on = false;
+        return false;
+    }
 
-    uint16_t peak_width = 2;
+    uint16_t    num = stop - start;
 
-    for (uint16_t i = 0; i < num; i++) {
-        if (i < peak_width) {
-            peak_db += fft_items[i].db;
-        } else {
-            noise_db += fft_items[i].db;
-        }
-    }
+    /* Mean of the strongest bins and of all the others */
 
-    peak_db /= peak_width;
-    noise_db /= num - peak_width;
+    order_tails(&audio_psd_sum[start], num, num - peak_width, peak_width, &noise_db, &peak_db, peak_work);
 
     if (peak_db > -3.0f)
         peak_db = -3.0f;
@@ -138,7 +120,13 @@ static bool cw_get_peak() {
 
 #if 0
     if (peak_on) {
-        peak_n = fft_items[0].n;
+        peak_n = start;
+
+        for (uint16_t n = start; n < stop; n++) {
+            if (audio_psd_sum[n] > audio_psd_sum[peak_n]) {
+                peak_n = n;
+            }
+        }
     } else {
         peak_n = 0;
     }
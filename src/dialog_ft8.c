@@ -50,6 +50,7 @@
 #include "ft8/crc.h"
 #include "gfsk.h"
 #include "fpga/adc.h"
+#include "dsp/db.h"
 
 #define MIN_SCORE       10
 #define MAX_CANDIDATES  120
@@ -151,6 +152,7 @@ static pthread_t            thread;
 static complex float        *rx_window = NULL;
 static complex float        *time_buf;
 static complex float        *freq_buf;
+static float                *power_buf;
 static windowcf             frame_window;
 static fftplan              fft;
 
@@ -264,6 +266,7 @@ static void init() {
 
     time_buf = (float complex*) malloc(nfft * sizeof(float complex));
     freq_buf = (float complex*) malloc(nfft * sizeof(float complex));
+    power_buf = (float *) malloc(num_bins * sizeof(float));
     fft = fft_create_plan(nfft, time_buf, freq_buf, LIQUID_FFT_FORWARD, 0);
 
     frame_window = windowcf_create(nfft);
@@ -313,6 +316,7 @@ static void done() {
 
     free(time_buf);
     free(freq_buf);
+    free(power_buf);
     fft_destroy_plan(fft);
 
     spgramcf_destroy(waterfall_sg);
@@ -485,23 +489,19 @@ void static process(float complex *frame) {
 
         fft_execute(fft);
 
-        for (int freq_sub = 0; freq_sub < wf.freq_osr; freq_sub++)
+        /* Magnitude is db * 2 + 240, so -120 dB .. 7.5 dB maps to 0 .. 255 */
+
+        for (int freq_sub = 0; freq_sub < wf.freq_osr; freq_sub++) {
             for (int bin = 0; bin < wf.num_bins; bin++) {
                 int             src_bin = (bin * wf.freq_osr) + freq_sub;
                 complex float   freq = freq_buf[src_bin];
-                float           v = crealf(freq * conjf(freq));
-                float           db = 10.0f * log10f(v);
-                int             scaled = (int16_t) (db * 2.0f + 240.0f);
-
-                if (scaled < 0) {
-                    scaled = 0;
-                } else if (scaled > 255) {
-                    scaled = 255;
-                }
 
-                wf.mag[offset] = scaled;
-                offset++;
+                power_buf[bin] = crealf(freq * conjf(freq));
             }
+
+            db_index_from_power(power_buf, &wf.mag[offset], wf.num_bins, 0.0f, -120.0f, 7.5f);
+            offset += wf.num_bins;
+        }
     }
 
     wf.num_blocks++;
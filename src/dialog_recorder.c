@@ -30,6 +30,8 @@
 #include "msgs.h"
 #include "buttons.h"
 #include "dsp.h"
+#include "iq_play.h"
+#include "fft_play.h"
 
 #define BUF_SIZE 1024
 
@@ -142,6 +144,30 @@ static const char* get_item() {
     return lv_table_get_cell_value(table, row, col);
 }
 
+/* IQ goes through the receiver, FFT to the panadapter, like live data does */
+
+static void play_stream(const char *filename, bool (*start)(const char *), bool (*is_on)(), void (*stop)()) {
+    if (!start(filename)) {
+        return;
+    }
+
+    play_state = true;
+
+    while (play_state && is_on()) {
+        usleep(100000);
+    }
+
+    stop();
+    play_state = false;
+}
+
+static bool has_ext(const char *item, const char *ext) {
+    size_t len = strlen(item);
+    size_t ext_len = strlen(ext);
+
+    return len > ext_len && strcmp(&item[len - ext_len], ext) == 0;
+}
+
 static void play_item() {
     const char *item = get_item();
 
@@ -155,6 +181,16 @@ static void play_item() {
     strcat(filename, "/");
     strcat(filename, item);
 
+    if (has_ext(item, ".iq")) {
+        play_stream(filename, iq_play_start, iq_play_is_on, iq_play_stop);
+        return;
+    }
+
+    if (has_ext(item, ".fft")) {
+        play_stream(filename, fft_play_start, fft_play_is_on, fft_play_stop);
+        return;
+    }
+
     SF_INFO sfinfo;
 
     memset(&sfinfo, 0, sizeof(sfinfo));
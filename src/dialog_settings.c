@@ -546,6 +546,8 @@ static action_items_t long_action_items[] = {
     { .label = " Recorder on/off ", .action = ACTION_RECORDER },
     { .label = " Mute ", .action = ACTION_MUTE },
     { .label = " Voice mode ", .action = ACTION_VOICE_MODE },
+    { .label = " IQ capture on/off ", .action = ACTION_IQ_CAPTURE },
+    { .label = " FFT capture on/off ", .action = ACTION_FFT_CAPTURE },
     { .label = " APP RTTY ", .action = ACTION_APP_RTTY },
     { .label = " APP FT8 ", .action = ACTION_APP_FT8 },
     { .label = " APP SWR Scan ", .action = ACTION_APP_SWRSCAN },
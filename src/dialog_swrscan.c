@@ -17,6 +17,7 @@
 #include "styles.h"
 #include "settings/op_work.h"
 #include "settings/swrscan.h"
+#include "hw/iio.h"
 #include "radio.h"
 #include "events.h"
 #include "util.h"
@@ -99,6 +100,8 @@ static void do_step(float vswr) {
     uint64_t freq = freq_start + (freq_stop - freq_start) * freq_index / STEPS;
     radio_set_freq_rx(freq);
     radio_set_freq_fft(freq);
+    radio_tune_commit();
+    iio_power_restart();
 }
 
 static lv_coord_t calc_y(float vswr) {
@@ -264,6 +267,8 @@ void dialog_swrscan_run_cb(lv_event_t * e) {
         do_init();
         radio_set_freq_rx(freq_start);
         radio_set_freq_fft(freq_start);
+        radio_tune_commit();
+        iio_power_restart();
         run = radio_start_swrscan();
     }
 }
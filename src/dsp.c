@@ -7,12 +7,18 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <errno.h>
 #include <math.h>
 #include <specbleach_adenoiser.h>
 
 #include "dsp.h"
 #include "util.h"
+#include "ring.h"
 #include "radio.h"
 #include "meter.h"
 #include "audio.h"
@@ -39,25 +45,76 @@
 #include "olivia/olivia.h"
 #include "dsp/biquad.h"
 #include "dsp/emnr.h"
+#include "dsp/fftfilt.h"
+#include "dsp/fircache.h"
+#include "dsp/db.h"
+#include "dsp/order.h"
 #include "two_tone.h"
+#include "bands/bands.h"
+
+#define FFTFILT_TAPS    192     /* Longer filters are cheaper by overlap-save */
+#define FFTFILT_BLOCK   64
+#define AUTO_PERCENT    3.75f   /* Noise floor and peak tails of the auto levels */
+#define FILTER_FADE     256     /* Crossfade samples on a filter change, or out and in halves between FIR and fftfilt */
+#define FILTER_HIST     1024    /* Input kept to prime a new filter, covers transitions down to 23 Hz */
+#define DENOISE_DEPTH   2       /* Blocks in flight on the denoise worker */
+#define DENOISE_RING    8192
+#define DENOISE_STATS   5000    /* ms */
+#define FFT_STATS       5000    /* ms */
+
+typedef struct {
+    firfilt_rrrf    fir;
+    fftfilt_t       *fft;
+    size_t          len;
+} rx_filter_t;
+
+typedef struct {
+    uint32_t        seq;
+    uint32_t        samples;
+    float           data[ADC_SAMPLES];
+} audio_block_t;
+
+#define PSD_INDEX       3
+#define PSD_FRESH       4
+#define PSD_MAX_FRAMES  64      /* A stalled consumer gets older frames dropped */
+
+typedef struct {
+    float           *sum;
+    uint32_t        count;
+} psd_acc_t;
+
+/*
+ * Triple buffer of accumulated FFT frames. The producer owns back, the consumer
+ * owns front and they swap through middle. While the published middle is not
+ * taken, back is kept equal to it, so every publish carries the whole average
+ */
+
+typedef struct {
+    psd_acc_t       acc[3];
+    size_t          size;
+    uint8_t         back;
+    uint8_t         pub;
+    bool            restart;
+    uint8_t         front;
+    atomic_uint     middle;
+    atomic_uint     dropped;
+} psd_buf_t;
 
 const uint16_t                  fft_over = (FFT_SAMPLES - 800) / 2;
 
 static float                    fft_correct_db = 85.0f;
+static uint8_t                  spectrum_factor = 1;
 static float                    meter_correct_db = 50.0f;
 
-static float                    *spectrum_psd;
-static uint16_t                 spectrum_psd_count = 0;
+static psd_buf_t                spectrum_psd;
 static msgs_auto_t              spectrum_auto_msg;
 static msgs_floats_t            spectrum_data_msg;
+static float                    *spectrum_db;
 static lv_timer_t               *spectrum_timer = NULL;
-static pthread_mutex_t          spectrum_mux;
 
-static float                    *waterfall_psd;
-static uint16_t                 waterfall_psd_count = 0;
+static psd_buf_t                waterfall_psd;
 static lv_timer_t               *waterfall_timer = NULL;
 static msgs_auto_t              waterfall_auto_msg;
-static pthread_mutex_t          waterfall_mux;
 static msgs_floats_t            waterfall_data_msg;
 
 static firhilbf                 demod_ssb;
@@ -66,15 +123,21 @@ static agc_t                    *rx_agc;
 
 static firhilbf                 mod_ssb;
 
-static size_t                   filter_len = 0;
-static float                    *filter_taps = NULL;
-static bool                     filter_need_update = false;
-static firfilt_rrrf             filter = NULL;
-
-static float                    *auto_psd;
-static uint16_t                 auto_psd_count = 0;
+static rx_filter_t              *filter = NULL;
+static rx_filter_t              *filter_prev = NULL;
+static uint16_t                 filter_fade = 0;
+static bool                     filter_dip = false;
+static _Atomic(rx_filter_t *)   filter_next = NULL;
+static _Atomic(rx_filter_t *)   filter_retired = NULL;
+static filter_t                 filter_req;
+static bool                     filter_req_ready = false;
+static pthread_mutex_t          filter_mux = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t           filter_cond = PTHREAD_COND_INITIALIZER;
+
+static psd_buf_t                auto_psd;
+static float                    *auto_view;
+static float                    *auto_work;
 static lv_timer_t               *auto_timer = NULL;
-static pthread_mutex_t          auto_mux;
 
 static uint8_t                  meter_count = 0;
 static float                    meter_db = 0.0f;
@@ -92,37 +155,142 @@ static int16_t                  adc_buf[ADC_SAMPLES];
 static float                    adc_vol = 0;
 static bool                     adc_mute = false;
 
-static bool                     adc_equalizer_update = true;
-static biquad_t                 adc_equalizer[EQUALIZER_NUM];
+static biquad_cascade_t         adc_equalizer;
 
 static float                    audio_buf[ADC_SAMPLES];
 static float                    denoised_buf[ADC_SAMPLES];
+static float                    agc_buf[ADC_SAMPLES];
+static float                    fade_buf[ADC_SAMPLES];
+static float                    filter_hist[FILTER_HIST];
+static float                    prime_buf[FILTER_HIST];
 static SpectralBleachHandle     denoise;
-static bool                     denoise_need_update = true;
+static atomic_bool              denoise_need_update = true;
 static emnr_t                   *emnr;
 
+static bool                     denoise_pipe = false;
+static ring_t                   *denoise_in;
+static ring_t                   *denoise_out;
+static sem_t                    denoise_sem;
+static audio_block_t            denoise_put;
+static audio_block_t            denoise_get;
+static audio_block_t            denoise_work;
+static audio_block_t            denoise_done;
+static bool                     denoise_idle = true;
+static uint32_t                 denoise_seq = 0;
+static uint32_t                 denoise_resume = 0;
+static uint8_t                  denoise_prime = 0;
+static atomic_uint_fast64_t     denoise_late = 0;
+static atomic_uint_fast64_t     denoise_dropped = 0;
+
 static void calc_auto();
 static void spectrum_timer_cb(lv_timer_t *t);
 static void waterfall_timer_cb(lv_timer_t *t);
 static void auto_timer_cb(lv_timer_t *t);
 static void meter_timer_cb(lv_timer_t *t);
+static void * filter_thread(void *arg);
+static void * denoise_thread(void *arg);
+static void denoise_stats_timer_cb(lv_timer_t *t);
+static void fft_stats_timer_cb(lv_timer_t *t);
 
 /* * */
 
 static float dB(float x) {
-    if (x > 0.0f) {
-        return 10.0f * log10f(x) - fft_correct_db;
+    float y;
+
+    db_from_power(&x, &y, 1, -fft_correct_db, S_MIN);
+
+    return y;
+}
+
+/* * */
+
+static void psd_init(psd_buf_t *psd, size_t size) {
+    for (int i = 0; i < 3; i++) {
+        psd->acc[i].sum = (float *) calloc(size, sizeof(float));
+        psd->acc[i].count = 0;
+    }
+
+    psd->size = size;
+    psd->back = 0;
+    psd->front = 1;
+    psd->pub = 2;
+    psd->restart = false;
+
+    atomic_init(&psd->middle, 2);
+    atomic_init(&psd->dropped, 0);
+}
+
+/* Producer, before the frame is added to back */
+
+static void psd_begin(psd_buf_t *psd) {
+    psd_acc_t *acc = &psd->acc[psd->back];
+
+    psd->restart = acc->count >= PSD_MAX_FRAMES;
+
+    if (psd->restart) {
+        memset(acc->sum, 0, psd->size * sizeof(float));
+        acc->count = 0;
+    }
+
+    acc->count++;
+}
+
+/* Producer, after the frame was added to back */
+
+static void psd_publish(psd_buf_t *psd, const float *frame) {
+    unsigned int    expected = psd->pub | PSD_FRESH;
+    psd_acc_t       *acc;
+
+    if (atomic_compare_exchange_strong(&psd->middle, &expected, psd->back | PSD_FRESH)) {
+        /* Not taken yet, the replaced one becomes back and catches up */
+
+        uint8_t prev = psd->pub;
+
+        psd->pub = psd->back;
+        psd->back = prev;
+        acc = &psd->acc[prev];
+
+        if (!psd->restart) {
+            for (size_t i = 0; i < psd->size; i++) {
+                acc->sum[i] += frame[i];
+            }
+
+            acc->count++;
+            return;
+        }
+
+        atomic_fetch_add(&psd->dropped, acc->count);
     } else {
-        return S_MIN;
+        /* Taken, so back holds frames the consumer already has. Start over from this frame */
+
+        acc = &psd->acc[psd->back];
+        memcpy(acc->sum, frame, psd->size * sizeof(float));
+        acc->count = 1;
+
+        unsigned int prev = atomic_exchange(&psd->middle, psd->back | PSD_FRESH);
+
+        psd->pub = psd->back;
+        psd->back = prev & PSD_INDEX;
+        acc = &psd->acc[psd->back];
     }
+
+    memcpy(acc->sum, frame, psd->size * sizeof(float));
+    acc->count = 1;
 }
 
-/* * */
+/* Consumer, NULL if nothing new was published */
+
+static psd_acc_t * psd_take(psd_buf_t *psd) {
+    if (!(atomic_load(&psd->middle) & PSD_FRESH)) {
+        return NULL;
+    }
+
+    psd->front = atomic_exchange(&psd->middle, psd->front) & PSD_INDEX;
+
+    return &psd->acc[psd->front];
+}
 
 void dsp_init() {
-    pthread_mutex_init(&spectrum_mux, NULL);
-    pthread_mutex_init(&waterfall_mux, NULL);
-    pthread_mutex_init(&auto_mux, NULL);
     pthread_mutex_init(&meter_mux, NULL);
 
     spectrum_data_msg.size = 800;
@@ -131,19 +299,25 @@ void dsp_init() {
     for (uint16_t i = 0; i < spectrum_data_msg.size; i++)
         spectrum_data_msg.data[i] = S_MIN;
 
-    spectrum_psd = (float *) malloc(spectrum_data_msg.size * sizeof(float));
+    psd_init(&spectrum_psd, spectrum_data_msg.size);
+    psd_init(&waterfall_psd, FFT_SAMPLES);
+    psd_init(&auto_psd, spectrum_data_msg.size);
 
-    waterfall_psd = (float *) malloc(FFT_SAMPLES * sizeof(float));
-    auto_psd = (float *) malloc(FFT_SAMPLES * sizeof(float));
+    spectrum_db = (float *) malloc(spectrum_data_msg.size * sizeof(float));
+    auto_view = (float *) malloc(spectrum_data_msg.size * sizeof(float));
+    auto_work = (float *) malloc(spectrum_data_msg.size * sizeof(float));
 
     waterfall_data_msg.size = FFT_SAMPLES;
-    waterfall_data_msg.data = waterfall_psd;
+    waterfall_data_msg.data = (float *) malloc(FFT_SAMPLES * sizeof(float));
 
     demod_ssb = firhilbf_create(15, 60.0f);
     demod_dc_block = firfilt_rrrf_create_dc_blocker(25, 20.0f);
 
     mod_ssb = firhilbf_create(15, 60.0f);
 
+    biquad_cascade_init(&adc_equalizer);
+    dsp_update_equalizer();
+
     rx_agc = agc_create(
         AGC_FAST,   /* mode */
         ADC_RATE,   /* sample rate */
@@ -167,6 +341,11 @@ void dsp_init() {
 
     delay = 4;
 
+    pthread_t thread;
+
+    pthread_create(&thread, NULL, filter_thread, NULL);
+    pthread_detach(thread);
+
     dsp_set_vol(options->audio.speaker.vol);
     ready = true;
 
@@ -174,13 +353,36 @@ void dsp_init() {
     waterfall_timer = lv_timer_create(waterfall_timer_cb, 1000 / 10, NULL);
     auto_timer = lv_timer_create(auto_timer_cb, 1000 / 10, NULL);
     meter_timer = lv_timer_create(meter_timer_cb, 1000 / 10, NULL);
+    lv_timer_create(fft_stats_timer_cb, FFT_STATS, NULL);
 
     denoise = specbleach_adaptive_initialize(ADC_RATE, options->audio.denoise.nr.frame_size);
+    denoise_pipe = options->audio.denoise.pipeline;
+
+    if (denoise_pipe) {
+        denoise_in = ring_create(DENOISE_RING);
+        denoise_out = ring_create(DENOISE_RING);
+
+        if (!denoise_in || !denoise_out) {
+            LV_LOG_ERROR("Unable to allocate denoise rings, pipeline is off");
+
+            if (denoise_in) {
+                ring_destroy(denoise_in);
+            }
+
+            if (denoise_out) {
+                ring_destroy(denoise_out);
+            }
+
+            denoise_pipe = false;
+        }
+    }
+
+    /* EMNR is bound to its buffers, the worker has its own */
 
     emnr = emnr_create(
         32,             /* samples */
-        audio_buf,
-        denoised_buf,
+        denoise_pipe ? denoise_work.data : audio_buf,
+        denoise_pipe ? denoise_done.data : denoised_buf,
         options->audio.denoise.emnr.fft,
         options->audio.denoise.emnr.over,
         ADC_RATE,
@@ -191,6 +393,22 @@ void dsp_init() {
         1
     );
 
+    if (denoise_pipe) {
+        sem_init(&denoise_sem, 0, 0);
+
+        pthread_create(&thread, NULL, denoise_thread, NULL);
+
+        if (!thread_set_rt(thread, options->threads.denoise.prio, options->threads.denoise.affinity)) {
+            LV_LOG_WARN("Unable to set denoise thread priority %i, affinity %02X",
+                options->threads.denoise.prio, options->threads.denoise.affinity);
+        }
+
+        pthread_detach(thread);
+
+        LV_LOG_INFO("Denoise pipelined, %i ms added while on", dsp_get_denoise_latency());
+        lv_timer_create(denoise_stats_timer_cb, DENOISE_STATS, NULL);
+    }
+
     two_tone_update();
 }
 
@@ -198,16 +416,249 @@ void dsp_reset() {
     delay = 4;
 }
 
-void dsp_set_filter(filter_t *filter) {
-    size_t len = firdes_compute_taps_len(ADC_RATE, filter->transition, 40.0f);
+static rx_filter_t * filter_create(const float *taps, size_t len) {
+    rx_filter_t *f = (rx_filter_t *) calloc(1, sizeof(rx_filter_t));
+
+    f->len = len;
+
+    if (len > FFTFILT_TAPS) {
+        f->fft = fftfilt_create(taps, len, FFTFILT_BLOCK);
+    } else {
+        f->fir = firfilt_rrrf_create((float *) taps, len);
+    }
+
+    return f;
+}
+
+static void filter_destroy(rx_filter_t *f) {
+    if (f->fft) {
+        fftfilt_destroy(f->fft);
+    } else {
+        firfilt_rrrf_destroy(f->fir);
+    }
+
+    free(f);
+}
+
+static void filter_execute(rx_filter_t *f, float *buf, size_t samples) {
+    if (f->fft) {
+        fftfilt_execute_block(f->fft, buf, buf, samples);
+    } else {
+        firfilt_rrrf_execute_block(f->fir, buf, samples, buf);
+    }
+}
+
+/* Runs a new filter over the recent input, so it starts with full history instead of ramping up from zeros */
+
+static void filter_prime(rx_filter_t *f) {
+    size_t n = f->len + (f->fft ? FFTFILT_BLOCK : 0);
+
+    if (n > FILTER_HIST) {
+        n = FILTER_HIST;
+    }
+
+    memcpy(prime_buf, filter_hist + FILTER_HIST - n, n * sizeof(float));
+    filter_execute(f, prime_buf, n);
+}
+
+/* Designs the taps away from the UI and ADC threads, and frees filters the ADC thread is done with */
+
+static void * filter_thread(void *arg) {
+    while (true) {
+        struct timespec ts;
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 100 * 1000000;
+
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+
+        pthread_mutex_lock(&filter_mux);
+
+        while (!filter_req_ready && atomic_load(&filter_retired) == NULL) {
+            if (pthread_cond_timedwait(&filter_cond, &filter_mux, &ts) == ETIMEDOUT) {
+                break;
+            }
+        }
+
+        bool        ready = filter_req_ready;
+        filter_t    req = filter_req;
+
+        filter_req_ready = false;
+        pthread_mutex_unlock(&filter_mux);
+
+        rx_filter_t *old = atomic_exchange(&filter_retired, NULL);
+
+        if (old) {
+            filter_destroy(old);
+        }
+
+        if (ready) {
+            size_t      len;
+            const float *taps = fircache_band_pass(ADC_RATE, req.low, req.high, req.transition, &len);
+
+            /* Not yet taken by the ADC thread, a newer one supersedes it */
+
+            old = atomic_exchange(&filter_next, filter_create(taps, len));
+
+            if (old) {
+                filter_destroy(old);
+            }
+        }
+    }
+}
+
+/* Denoise of one block. Runs on the ADC thread, or on the worker when pipelined */
+
+static float * denoise_process(float *in, float *out, uint16_t samples) {
+    /* Cleared before options are read, so a change made meanwhile is taken next time */
+
+    if (atomic_exchange(&denoise_need_update, false)) {
+        SpectralBleachParameters parameters;
+
+        parameters.residual_listen = false;
+        parameters.reduction_amount = options->audio.denoise.nr.reduction_amount;
+        parameters.smoothing_factor = options->audio.denoise.nr.smoothing_factor;
+        parameters.whitening_factor = options->audio.denoise.nr.whitening_factor;
+        parameters.noise_scaling_type = options->audio.denoise.nr.noise_scaling_type;
+        parameters.noise_rescale = options->audio.denoise.nr.noise_rescale;
+        parameters.post_filter_threshold = options->audio.denoise.nr.post_filter_threshold;
+
+        specbleach_adaptive_load_parameters(denoise, parameters);
+
+        emnr_set_gain_method(emnr, options->audio.denoise.emnr.gain_method);
+        emnr_set_npe_method(emnr, options->audio.denoise.emnr.npe_method);
+        emnr_set_trained_thresh(emnr, options->audio.denoise.emnr.trained_thresh);
+        emnr_set_trained_t2(emnr, options->audio.denoise.emnr.trained_t2);
+    }
+
+    switch (options->audio.denoise.mode) {
+        case DENOISE_NR:
+            specbleach_adaptive_process(denoise, samples, in, out);
+            return out;
+
+        case DENOISE_EMNR:
+            emnr_apply(emnr);
+            return out;
+
+        default:
+            return in;
+    }
+}
+
+static void * denoise_thread(void *arg) {
+    while (true) {
+        sem_wait(&denoise_sem);
+        ring_read(denoise_in, &denoise_work, sizeof(denoise_work));
 
-    if (filter_len != len) {
-        filter_taps = realloc(filter_taps, len * sizeof(float));
-        filter_len = len;
+        float *res = denoise_process(denoise_work.data, denoise_done.data, denoise_work.samples);
+
+        if (res != denoise_done.data) {
+            memcpy(denoise_done.data, res, denoise_work.samples * sizeof(float));
+        }
+
+        denoise_done.seq = denoise_work.seq;
+        denoise_done.samples = denoise_work.samples;
+
+        if (!ring_write(denoise_out, &denoise_done, sizeof(denoise_done))) {
+            atomic_fetch_add(&denoise_dropped, 1);
+        }
+    }
+}
+
+static inline bool denoise_stale(const audio_block_t *block) {
+    return (int32_t) (block->seq - denoise_resume) < 0;
+}
+
+/*
+ * Hands the block to the worker and takes the one finished DENOISE_DEPTH blocks
+ * ago. A late worker gives silence, its block is dropped later to keep the delay.
+ * After a pause, DENOISE_DEPTH blocks of silence set the delay up again and
+ * blocks left from before it are skipped
+ */
+
+static float * denoise_pipe_run(float *in, uint16_t samples) {
+    if (denoise_idle) {
+        denoise_idle = false;
+        denoise_resume = denoise_seq;
+        denoise_prime = DENOISE_DEPTH;
+    }
+
+    denoise_put.seq = denoise_seq++;
+    denoise_put.samples = samples;
+    memcpy(denoise_put.data, in, samples * sizeof(float));
+
+    if (ring_write(denoise_in, &denoise_put, sizeof(denoise_put))) {
+        sem_post(&denoise_sem);
+    } else {
+        atomic_fetch_add(&denoise_dropped, 1);
     }
 
-    firdes_band_pass(1.0f, ADC_RATE, filter->low, filter->high, filter_taps, filter_len);
-    filter_need_update = true;
+    if (denoise_prime) {
+        denoise_prime--;
+        memset(denoise_get.data, 0, samples * sizeof(float));
+
+        return denoise_get.data;
+    }
+
+    while (ring_used(denoise_out) > (DENOISE_DEPTH + 1) * sizeof(audio_block_t)) {
+        ring_read(denoise_out, &denoise_get, sizeof(denoise_get));
+
+        if (!denoise_stale(&denoise_get)) {
+            atomic_fetch_add(&denoise_dropped, 1);
+        }
+    }
+
+    bool ready;
+
+    do {
+        ready = ring_read(denoise_out, &denoise_get, sizeof(denoise_get)) == sizeof(denoise_get);
+    } while (ready && denoise_stale(&denoise_get));
+
+    if (!ready) {
+        memset(denoise_get.data, 0, samples * sizeof(float));
+        atomic_fetch_add(&denoise_late, 1);
+    } else if (denoise_get.samples < samples) {
+        memset(&denoise_get.data[denoise_get.samples], 0, (samples - denoise_get.samples) * sizeof(float));
+    }
+
+    return denoise_get.data;
+}
+
+static void denoise_stats_timer_cb(lv_timer_t *t) {
+    static uint64_t     prev = 0;
+    dsp_denoise_stats_t stats;
+
+    dsp_get_denoise_stats(&stats);
+
+    if (stats.late + stats.dropped == prev) {
+        return;
+    }
+
+    prev = stats.late + stats.dropped;
+
+    LV_LOG_WARN("Denoise %llu blocks late, %llu dropped",
+        (unsigned long long) stats.late, (unsigned long long) stats.dropped);
+}
+
+int dsp_get_denoise_latency() {
+    return denoise_pipe ? DENOISE_DEPTH * ADC_SAMPLES * 1000 / ADC_RATE : 0;
+}
+
+void dsp_get_denoise_stats(dsp_denoise_stats_t *stats) {
+    stats->latency_ms = dsp_get_denoise_latency();
+    stats->late = atomic_load(&denoise_late);
+    stats->dropped = atomic_load(&denoise_dropped);
+}
+
+void dsp_set_filter(filter_t *filter) {
+    pthread_mutex_lock(&filter_mux);
+    filter_req = *filter;
+    filter_req_ready = true;
+    pthread_cond_signal(&filter_cond);
+    pthread_mutex_unlock(&filter_mux);
 
     lv_msg_send(MSG_FILTER_CHANGED, NULL);
 }
@@ -227,7 +678,7 @@ int dsp_change_denoise(int16_t d) {
 }
 
 void dsp_update_denoise() {
-    denoise_need_update = true;
+    atomic_store(&denoise_need_update, true);
 }
 
 uint8_t dsp_change_rx_agc(int16_t df) {
@@ -243,63 +694,51 @@ uint8_t dsp_change_rx_agc(int16_t df) {
 }
 
 static void auto_timer_cb(lv_timer_t *t) {
-    if (auto_psd_count == 0) {
+    psd_acc_t *acc = psd_take(&auto_psd);
+
+    if (!acc) {
         return;
     }
 
-    pthread_mutex_lock(&auto_mux);
-
-    for (size_t i = 0; i < FFT_SAMPLES; i++) {
-        auto_psd[i] /= auto_psd_count;
+    for (size_t i = 0; i < auto_psd.size; i++) {
+        auto_view[i] = acc->sum[i] / acc->count;
     }
 
     calc_auto();
-    auto_psd_count = 0;
-    memset(auto_psd, 0, FFT_SAMPLES * sizeof(float));
-
-    pthread_mutex_unlock(&auto_mux);
 }
 
 static void spectrum_timer_cb(lv_timer_t *t) {
-    if (spectrum_psd_count == 0) {
+    psd_acc_t *acc = psd_take(&spectrum_psd);
+
+    if (!acc) {
         return;
     }
 
-    pthread_mutex_lock(&spectrum_mux);
+    /* Average folded into the offset: log(sum / count) = log(sum) - log(count) */
 
-    for (uint16_t i = 0; i < spectrum_data_msg.size; i++) {
-        float x = spectrum_psd[i] / spectrum_psd_count;
+    float offset = -fft_correct_db - 10.0f * log10f(acc->count);
 
-        lpf(&spectrum_data_msg.data[i], dB(x), options->spectrum.beta);
+    db_from_power(acc->sum, spectrum_db, spectrum_data_msg.size, offset, S_MIN);
+
+    for (uint16_t i = 0; i < spectrum_data_msg.size; i++) {
+        lpf(&spectrum_data_msg.data[i], spectrum_db[i], options->spectrum.beta);
     }
 
     lv_msg_send(MSG_SPECTRUM_DATA, &spectrum_data_msg);
-
-    spectrum_psd_count = 0;
-    memset(spectrum_psd, 0, spectrum_data_msg.size * sizeof(float));
-
-    pthread_mutex_unlock(&spectrum_mux);
 }
 
 static void waterfall_timer_cb(lv_timer_t *t) {
-    if (waterfall_psd_count == 0) {
+    psd_acc_t *acc = psd_take(&waterfall_psd);
+
+    if (!acc) {
         return;
     }
 
-    pthread_mutex_lock(&waterfall_mux);
-
-    for (uint16_t i = 0; i < FFT_SAMPLES; i++) {
-        float x = waterfall_psd[i] / waterfall_psd_count;
+    float offset = -fft_correct_db - 10.0f * log10f(acc->count);
 
-        waterfall_psd[i] = dB(x);
-    }
+    db_from_power(acc->sum, waterfall_data_msg.data, FFT_SAMPLES, offset, S_MIN);
 
     lv_msg_send(MSG_WATERFALL_DATA, &waterfall_data_msg);
-
-    waterfall_psd_count = 0;
-    memset(waterfall_psd, 0, FFT_SAMPLES * sizeof(float));
-
-    pthread_mutex_unlock(&waterfall_mux);
 }
 
 void dsp_fft(float *data) {
@@ -309,35 +748,57 @@ void dsp_fft(float *data) {
         return;
     }
 
+    psd_begin(&waterfall_psd);
+    psd_begin(&spectrum_psd);
+    psd_begin(&auto_psd);
+
+    float   *waterfall = waterfall_psd.acc[waterfall_psd.back].sum;
+    float   *spectrum = spectrum_psd.acc[spectrum_psd.back].sum;
+    float   *level = auto_psd.acc[auto_psd.back].sum;
+
+    /* One pass: reorder and add to every consumer */
+
     for (size_t i = 0; i < FFT_SAMPLES; i++) {
-        uint16_t    index = (i + FFT_SAMPLES / 2) % FFT_SAMPLES;
+        float x = data[(i + FFT_SAMPLES / 2) % FFT_SAMPLES];
 
-        fft_buf[index] = data[i];
-    }
+        fft_buf[i] = x;
+        waterfall[i] += x;
+
+        size_t j = i - fft_over;
 
-    pthread_mutex_lock(&waterfall_mux);
+        if (j < spectrum_psd.size) {
+            spectrum[j] += x;
+            level[j] += x;
+        }
+    }
 
-    for (size_t i = 0; i < FFT_SAMPLES; i++)
-        waterfall_psd[i] += fft_buf[i];
+    psd_publish(&waterfall_psd, fft_buf);
+    psd_publish(&spectrum_psd, fft_buf + fft_over);
+    psd_publish(&auto_psd, fft_buf + fft_over);
+}
 
-    waterfall_psd_count++;
+static void fft_stats_timer_cb(lv_timer_t *t) {
+    static uint64_t     prev = 0;
+    dsp_fft_dropped_t   dropped;
 
-    pthread_mutex_unlock(&waterfall_mux);
-    pthread_mutex_lock(&auto_mux);
+    dsp_get_fft_dropped(&dropped);
 
-    for (size_t i = 0; i < FFT_SAMPLES; i++)
-        auto_psd[i] += fft_buf[i];
+    uint64_t sum = (uint64_t) dropped.spectrum + dropped.waterfall + dropped.auto_level;
 
-    auto_psd_count++;
+    if (sum == prev) {
+        return;
+    }
 
-    pthread_mutex_unlock(&auto_mux);
-    pthread_mutex_lock(&spectrum_mux);
+    prev = sum;
 
-    for (size_t i = 0; i < spectrum_data_msg.size; i++)
-        spectrum_psd[i] += fft_buf[i + fft_over];
+    LV_LOG_WARN("FFT frames dropped: spectrum %u, waterfall %u, auto %u",
+        dropped.spectrum, dropped.waterfall, dropped.auto_level);
+}
 
-    spectrum_psd_count++;
-    pthread_mutex_unlock(&spectrum_mux);
+void dsp_get_fft_dropped(dsp_fft_dropped_t *dropped) {
+    dropped->spectrum = atomic_load(&spectrum_psd.dropped);
+    dropped->waterfall = atomic_load(&waterfall_psd.dropped);
+    dropped->auto_level = atomic_load(&auto_psd.dropped);
 }
 
 float complex dsp_modulate(float x, radio_mode_t mode) {
@@ -375,43 +836,53 @@ float complex dsp_modulate(float x, radio_mode_t mode) {
     return out;
 }
 
-float dsp_demodulate(float complex in, radio_mode_t mode) {
+void dsp_demodulate(float complex *in, float *out, size_t samples, radio_mode_t mode) {
     static float    last_phase = 0;
     float           phase, dphase;
     float           a, b;
-    float           out = 0.0f;
 
     switch (mode) {
         case RADIO_MODE_LSB:
         case RADIO_MODE_CWR:
-            firhilbf_c2r_execute(demod_ssb, in, &a, &b);
-            out = a;
+            for (size_t i = 0; i < samples; i++) {
+                firhilbf_c2r_execute(demod_ssb, in[i], &a, &b);
+                out[i] = a;
+            }
             break;
 
         case RADIO_MODE_USB:
         case RADIO_MODE_CW:
         case RADIO_MODE_RTTY:
         case RADIO_MODE_OLIVIA:
-            firhilbf_c2r_execute(demod_ssb, in, &a, &b);
-            out = b;
+            for (size_t i = 0; i < samples; i++) {
+                firhilbf_c2r_execute(demod_ssb, in[i], &a, &b);
+                out[i] = b;
+            }
             break;
 
         case RADIO_MODE_AM:
-            firfilt_rrrf_push(demod_dc_block, cabsf(in));
-            firfilt_rrrf_execute(demod_dc_block, &out);
+            for (size_t i = 0; i < samples; i++) {
+                out[i] = cabsf(in[i]);
+            }
+
+            firfilt_rrrf_execute_block(demod_dc_block, out, samples, out);
             break;
 
         case RADIO_MODE_NFM:
-            phase = atan2f(cimagf(in), crealf(in));
-            dphase = phase - last_phase;
-            while (dphase < -M_PI) dphase += 2 * M_PI;
-            while (dphase > M_PI) dphase -= 2 * M_PI;
-            out = dphase / M_PI;
-            last_phase = phase;
+            for (size_t i = 0; i < samples; i++) {
+                phase = atan2f(cimagf(in[i]), crealf(in[i]));
+                dphase = phase - last_phase;
+                while (dphase < -M_PI) dphase += 2 * M_PI;
+                while (dphase > M_PI) dphase -= 2 * M_PI;
+                out[i] = dphase / M_PI;
+                last_phase = phase;
+            }
             break;
-    }
 
-    return out;
+        default:
+            memset(out, 0, samples * sizeof(float));
+            break;
+    }
 }
 
 static void meter_timer_cb(lv_timer_t *t) {
@@ -428,7 +899,15 @@ static void meter_timer_cb(lv_timer_t *t) {
 }
 
 void dsp_update_equalizer() {
-    adc_equalizer_update = true;
+    biquad_t sections[EQUALIZER_NUM];
+
+    for (int i = 0; i < EQUALIZER_NUM; i++) {
+        const equalizer_item_t *item = &options->audio.speaker.eq[i];
+
+        biquad_peak_eq(&sections[i], item->freq, item->q * 0.5f, item->gain, ADC_RATE);
+    }
+
+    biquad_cascade_set(&adc_equalizer, sections, EQUALIZER_NUM);
 }
 
 void dsp_adc(float complex *data, uint16_t samples) {
@@ -441,110 +920,106 @@ void dsp_adc(float complex *data, uint16_t samples) {
     radio_mode_t    mode = op_work->mode;
     float           peak = 0.0f;
 
-    if (filter_need_update) {
-        if (filter) {
-            filter = firfilt_rrrf_recreate(filter, filter_taps, filter_len);
-        } else {
-            filter = firfilt_rrrf_create(filter_taps, filter_len);
-        }
-        filter_need_update = false;
-    }
-
-    if (adc_equalizer_update) {
-        for (int i = 0; i < EQUALIZER_NUM; i++) {
-            const equalizer_item_t *item = &options->audio.speaker.eq[i];
+    /* A new filter is taken once the previous change has faded out and was collected */
 
-            biquad_peak_eq(&adc_equalizer[i], item->freq, item->q * 0.5f, item->gain, ADC_RATE);
-        }
+    if (filter_fade == 0 && atomic_load(&filter_retired) == NULL) {
+        rx_filter_t *next = atomic_exchange(&filter_next, NULL);
 
-        adc_equalizer_update = false;
-    }
+        if (next) {
+            filter_prime(next);
 
-    float x, y;
+            if (filter) {
+                filter_prev = filter;
+                filter_fade = FILTER_FADE;
 
-    for (int i = 0; i < samples; i++) {
-        x = dsp_demodulate(data[i], mode);
+                /* FIR and overlap-save differ in delay by a block, summing them would comb */
 
-        for (int n = 0; n < EQUALIZER_NUM; n++) {
-            x = biqiad_apply(&adc_equalizer[n], x);
+                filter_dip = (filter->fft == NULL) != (next->fft == NULL);
+            }
+            filter = next;
         }
+    }
 
-        firfilt_rrrf_execute_one(filter, x, &y);
+    /* Demodulator, equalizer and filter, each over the whole block */
 
-        if (fabs(y) > peak) {
-            peak = fabs(y);
-        }
+    dsp_demodulate(data, audio_buf, samples, mode);
 
-        if (!options->audio.denoise.before_agc) {
-            y = agc_apply(rx_agc, y);
-        }
+    biquad_cascade_apply(&adc_equalizer, audio_buf, samples);
 
-        audio_buf[i] = y;
-    }
+    memmove(filter_hist, filter_hist + samples, (FILTER_HIST - samples) * sizeof(float));
+    memcpy(filter_hist + FILTER_HIST - samples, audio_buf, samples * sizeof(float));
 
-    if (denoise_need_update) {
-        SpectralBleachParameters parameters;
+    if (filter_fade) {
+        memcpy(fade_buf, audio_buf, samples * sizeof(float));
+        filter_execute(filter_prev, fade_buf, samples);
+        filter_execute(filter, audio_buf, samples);
 
-        parameters.residual_listen = false;
-        parameters.reduction_amount = options->audio.denoise.nr.reduction_amount;
-        parameters.smoothing_factor = options->audio.denoise.nr.smoothing_factor;
-        parameters.whitening_factor = options->audio.denoise.nr.whitening_factor;
-        parameters.noise_scaling_type = options->audio.denoise.nr.noise_scaling_type;
-        parameters.noise_rescale = options->audio.denoise.nr.noise_rescale;
-        parameters.post_filter_threshold = options->audio.denoise.nr.post_filter_threshold;
+        for (int i = 0; i < samples; i++) {
+            if (filter_fade) {
+                float k = (float) filter_fade / FILTER_FADE;
 
-        specbleach_adaptive_load_parameters(denoise, parameters);
+                if (!filter_dip) {
+                    audio_buf[i] = audio_buf[i] * (1.0f - k) + fade_buf[i] * k;
+                } else if (k > 0.5f) {
+                    audio_buf[i] = fade_buf[i] * (2.0f * k - 1.0f);
+                } else {
+                    audio_buf[i] = audio_buf[i] * (1.0f - 2.0f * k);
+                }
 
-        emnr_set_gain_method(emnr, options->audio.denoise.emnr.gain_method);
-        emnr_set_npe_method(emnr, options->audio.denoise.emnr.npe_method);
-        emnr_set_trained_thresh(emnr, options->audio.denoise.emnr.trained_thresh);
-        emnr_set_trained_t2(emnr, options->audio.denoise.emnr.trained_t2);
+                filter_fade--;
+            }
+        }
+
+        if (filter_fade == 0) {
+            atomic_store(&filter_retired, filter_prev);
+            filter_prev = NULL;
 
-        denoise_need_update = false;
+            pthread_mutex_lock(&filter_mux);
+            pthread_cond_signal(&filter_cond);
+            pthread_mutex_unlock(&filter_mux);
+        }
+    } else if (filter) {
+        filter_execute(filter, audio_buf, samples);
+    } else {
+        memset(audio_buf, 0, samples * sizeof(float));
     }
 
-    float *out_buf;
+    for (int i = 0; i < samples; i++) {
+        peak = fmaxf(peak, fabsf(audio_buf[i]));
+    }
 
-    switch (options->audio.denoise.mode) {
-        case DENOISE_OFF:
-            out_buf = audio_buf;
-            break;
+    if (!options->audio.denoise.before_agc) {
+        agc_apply_block(rx_agc, audio_buf, audio_buf, samples);
+    }
 
-        case DENOISE_NR:
-            specbleach_adaptive_process(denoise, samples, audio_buf, denoised_buf);
-            out_buf = denoised_buf;
-            break;
+    /* AGC is on this thread either way, before_agc only picks its side of denoise */
 
-        case DENOISE_EMNR:
-            emnr_apply(emnr);
-            out_buf = denoised_buf;
-            break;
-    }
+    float *out_buf;
 
-    for (int i = 0; i < samples; i++) {
-        x = out_buf[i];
+    if (!denoise_pipe) {
+        out_buf = denoise_process(audio_buf, denoised_buf, samples);
+    } else if (options->audio.denoise.mode != DENOISE_OFF) {
+        out_buf = denoise_pipe_run(audio_buf, samples);
+    } else {
+        /* No worker and no delay while denoise is off */
 
-        if (options->audio.denoise.before_agc) {
-            x = agc_apply(rx_agc, x);
-        }
+        denoise_idle = true;
+        out_buf = audio_buf;
+    }
 
-        y = x * 16384.0f;
+    float *play_buf = out_buf;
 
-        if (y > 16384.0f) {
-            y = 16384.0f;
-        } else if (y < -16384.0f) {
-            y = -16384.0f;
-        }
+    if (options->audio.denoise.before_agc) {
+        agc_apply_block(rx_agc, out_buf, agc_buf, samples);
+        play_buf = agc_buf;
+    }
 
-        y *= adc_vol;
+    /* Output scaling */
 
-        if (y > 16384.0f) {
-            y = 16384.0f;
-        } else if (y < -16384.0f) {
-            y = -16384.0f;
-        }
+    for (int i = 0; i < samples; i++) {
+        float y = fminf(fmaxf(play_buf[i] * 16384.0f, -16384.0f), 16384.0f) * adc_vol;
 
-        adc_buf[i] = (int16_t) y;
+        adc_buf[i] = (int16_t) fminf(fmaxf(y, -16384.0f), 16384.0f);
     }
 
     audio_adc_play(adc_buf, samples);
@@ -579,36 +1054,45 @@ void dsp_adc(float complex *data, uint16_t samples) {
 }
 
 void dsp_set_spectrum_factor(uint8_t x) {
+    spectrum_factor = x;
     control_set_fft_rate(240 * x);
     lv_msg_send(MSG_RATE_FFT_CHANGED, &x);
 }
 
+uint8_t dsp_get_spectrum_factor() {
+    return spectrum_factor;
+}
+
 void dsp_auto_clear() {
     auto_clear = true;
 }
 
-static int compare_fft(const void *p1, const void *p2) {
-    float *i1 = (float *) p1;
-    float *i2 = (float *) p2;
+static float auto_percent(float band, float global) {
+    if (band > 0.0f) {
+        return band;
+    }
 
-    return (*i1 < *i2) ? -1 : 1;
+    return global > 0.0f ? global : AUTO_PERCENT;
 }
 
 static void calc_auto() {
     float       min = 0;
     float       max = 0;
-    size_t      window = 30;
-    float       *view = auto_psd + fft_over;
-
-    qsort(view, 800, sizeof(float), compare_fft);
+    size_t      n = spectrum_data_msg.size;
+    float       floor_pct = auto_percent(band_settings ? band_settings->auto_floor : 0.0f, options->spectrum.auto_floor);
+    float       peak_pct = auto_percent(band_settings ? band_settings->auto_peak : 0.0f, options->spectrum.auto_peak);
+    size_t      floor_n = n * floor_pct / 100.0f;
+    size_t      peak_n = n * peak_pct / 100.0f;
+
+    if (floor_n == 0) {
+        floor_n = 1;
+    }
 
-    for (size_t i = 0; i < window; i++) {
-        min += view[i];
-        max += view[800 - i - 1];
+    if (peak_n == 0) {
+        peak_n = 1;
     }
 
-    min /= window;
-    max /= window;
+    order_tails(auto_view, n, floor_n, peak_n, &min, &max, auto_work);
 
     min = dB(min);
     max = dB(max);
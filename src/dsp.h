@@ -13,10 +13,23 @@
 #include <liquid/liquid.h>
 #include "settings/modes.h"
 
+typedef struct {
+    uint32_t    spectrum;
+    uint32_t    waterfall;
+    uint32_t    auto_level;
+} dsp_fft_dropped_t;
+
+typedef struct {
+    int         latency_ms; /* Added by the pipelined denoise while on, fixed */
+    uint64_t    late;       /* Blocks the worker did not finish in time */
+    uint64_t    dropped;
+} dsp_denoise_stats_t;
+
 void dsp_init();
 void dsp_reset();
 
 void dsp_set_spectrum_factor(uint8_t x);
+uint8_t dsp_get_spectrum_factor();
 void dsp_set_filter(filter_t *filter);
 void dsp_set_rx_agc(uint8_t mode);
 
@@ -24,6 +37,7 @@ float dsp_get_spectrum_beta();
 void dsp_set_spectrum_beta(float x);
 
 void dsp_auto_clear();
+void dsp_get_fft_dropped(dsp_fft_dropped_t *dropped);
 
 void dsp_change_mute();
 void dsp_set_mute(bool on);
@@ -33,9 +47,11 @@ uint8_t dsp_change_rx_agc(int16_t df);
 
 int dsp_change_denoise(int16_t d);
 void dsp_update_denoise();
+int dsp_get_denoise_latency();
+void dsp_get_denoise_stats(dsp_denoise_stats_t *stats);
 
 float complex dsp_modulate(float x, radio_mode_t mode);
-float dsp_demodulate(float complex in, radio_mode_t mode);
+void dsp_demodulate(float complex *in, float *out, size_t samples, radio_mode_t mode);
 
 void dsp_update_equalizer();
 
@@ -19,8 +19,10 @@
 #define MAX_N_TAU           (8)
 #define MAX_TAU_ATTACK      (0.01)
 #define RB_SIZE	            (int)(MAX_SAMPLE_RATE * MAX_N_TAU * MAX_TAU_ATTACK + 1)
+#define CHUNK               64
 
 static void agc_load(agc_t *a);
+static void max_restart(agc_t *a);
 
 void agc_calc(agc_t *a) {
     a->ring_buffsize = RB_SIZE;
@@ -36,11 +38,13 @@ void agc_calc(agc_t *a) {
     a->state = 0;
     a->ring = (float *) calloc(RB_SIZE, sizeof(float));
     a->abs_ring = (float *) calloc(RB_SIZE, sizeof(float));
+    a->max_suffix = (float *) calloc(RB_SIZE + 1, sizeof(float));
 
     agc_load(a);
 }
 
 void agc_decalc(agc_t *a) {
+    free(a->max_suffix);
     free(a->abs_ring);
     free(a->ring);
 }
@@ -107,6 +111,8 @@ static void agc_load(agc_t *a) {
     a->onemhang_backmult = 1.0f - a->hang_backmult;
 
     a->hang_decay_mult = 1.0f - expf(-1.0f / (a->sample_rate * a->tau_hang_decay));
+
+    max_restart(a);
 }
 
 void agc_destroy(agc_t *a) {
@@ -115,141 +121,236 @@ void agc_destroy(agc_t *a) {
 }
 
 void agc_flush(agc_t *a) {
-    memset((void *) a->ring, 0, sizeof(float) * RB_SIZE * 2);
+    memset((void *) a->ring, 0, sizeof(float) * RB_SIZE);
     a->ring_max = 0.0;
     memset ((void *) a->abs_ring, 0, sizeof(float) * RB_SIZE);
+    max_restart(a);
+}
+
+/*
+ * Sliding maximum of abs_ring over the attack window, the last attack_buffsize
+ * samples. The stream is cut in blocks of the window length: the maximum is
+ * that of the suffix of the previous block and the prefix of the current one.
+ * Exact, and three compares per sample at most, whatever the signal
+ */
+
+static void max_suffix(agc_t *a) {
+    int     k = a->in_index;
+    float   v = 0.0f;
+
+    for (int j = a->attack_buffsize - 1; j >= 0; j--) {
+        if (a->abs_ring[k] > v) {
+            v = a->abs_ring[k];
+        }
+
+        a->max_suffix[j] = v;
+
+        if (--k < 0) {
+            k = a->ring_buffsize - 1;
+        }
+    }
+
+    a->max_suffix[a->attack_buffsize] = 0.0f;
+    a->max_prefix = 0.0f;
+    a->max_offset = 0;
+}
+
+static void max_restart(agc_t *a) {
+    a->in_index %= a->ring_buffsize;
+    max_suffix(a);
+    a->ring_max = a->max_suffix[0];
 }
 
 float agc_apply(agc_t *a, float in) {
-    int i, j, k;
-    float mult;
+    float out;
+
+    agc_apply_block(a, &in, &out, 1);
+
+    return out;
+}
+
+/*
+ * Block of samples in passes: delay line and envelope, the gain state machine,
+ * then the output gain. in and out may be the same buffer
+ */
+
+void agc_apply_block(agc_t *a, const float *in, float *out, size_t n) {
+    float   delayed[CHUNK];
+    float   leaving[CHUNK];
+    float   env[CHUNK];
+    float   volts[CHUNK];
 
     if (a->mode == 0) {
-        return a->fixed_gain * in;
+        for (size_t i = 0; i < n; i++) {
+            out[i] = a->fixed_gain * in[i];
+        }
+        return;
     }
 
-    a->out_index = (a->out_index + 1) % a->ring_buffsize;
-    a->in_index = (a->in_index + 1) % a->ring_buffsize;
+    float   last_volts = 0.0f;
+    float   mult = 0.0f;
 
-    a->out_sample = a->ring[a->out_index];
-    a->abs_out_sample = a->abs_ring[a->out_index];
+    while (n) {
+        size_t  m = n < CHUNK ? n : CHUNK;
+        int     size = a->ring_buffsize;
+        int     out_index = a->out_index;
+        int     in_index = a->in_index;
+        float   prefix = a->max_prefix;
+        int     offset = a->max_offset;
 
-    a->ring[a->in_index] = in;
-    a->abs_ring[a->in_index] = fabs(in);
+        for (size_t i = 0; i < m; i++) {
+            if (++out_index == size) {
+                out_index = 0;
+            }
+
+            if (++in_index == size) {
+                in_index = 0;
+            }
 
-    a->fast_backaverage = a->fast_backmult * a->abs_out_sample + a->onemfast_backmult * a->fast_backaverage;
-    a->hang_backaverage = a->hang_backmult * a->abs_out_sample + a->onemhang_backmult * a->hang_backaverage;
+            float x = fabsf(in[i]);
+            float suffix = a->max_suffix[offset + 1];
 
-    if ((a->abs_out_sample >= a->ring_max) && (a->abs_out_sample > 0.0f)) {
-        a->ring_max = 0.0f;
-        k = a->out_index;
+            delayed[i] = a->ring[out_index];
+            leaving[i] = a->abs_ring[out_index];
+            a->ring[in_index] = in[i];
+            a->abs_ring[in_index] = x;
 
-        for (j = 0; j < a->attack_buffsize; j++) {
-            if (++k == a->ring_buffsize) {
-                k = 0;
+            if (x > prefix) {
+                prefix = x;
             }
 
-            if (a->abs_ring[k] > a->ring_max) {
-                a->ring_max = a->abs_ring[k];
+            env[i] = suffix > prefix ? suffix : prefix;
+
+            if (++offset == a->attack_buffsize) {
+                a->in_index = in_index;
+                max_suffix(a);
+                prefix = 0.0f;
+                offset = 0;
             }
         }
-    }
 
-    if (a->abs_ring[a->in_index] > a->ring_max) {
-        a->ring_max = a->abs_ring[a->in_index];
-    }
+        a->out_index = out_index;
+        a->in_index = in_index;
+        a->max_prefix = prefix;
+        a->max_offset = offset;
 
-    if (a->hang_counter > 0) {
-        --a->hang_counter;
-    }
+        for (size_t i = 0; i < m; i++) {
+            float ring_max = env[i];
 
-    switch (a->state) {
-        case 0:
-            if (a->ring_max >= a->volts) {
-                a->volts += (a->ring_max - a->volts) * a->attack_mult;
-            } else {
-                if (a->volts > a->pop_ratio * a->fast_backaverage) {
-                    a->state = 1;
-                    a->volts += (a->ring_max - a->volts) * a->fast_decay_mult;
-                } else {
-                    if (a->hang_enable && (a->hang_backaverage > a->hang_level)) {
-                        a->state = 2;
-                        a->hang_counter = (int)(a->hangtime * a->sample_rate);
-                        a->decay_type = 1;
+            a->fast_backaverage = a->fast_backmult * leaving[i] + a->onemfast_backmult * a->fast_backaverage;
+            a->hang_backaverage = a->hang_backmult * leaving[i] + a->onemhang_backmult * a->hang_backaverage;
+
+            if (a->hang_counter > 0) {
+                --a->hang_counter;
+            }
+
+            switch (a->state) {
+                case 0:
+                    if (ring_max >= a->volts) {
+                        a->volts += (ring_max - a->volts) * a->attack_mult;
                     } else {
-                        a->state = 3;
-                        a->volts += (a->ring_max - a->volts) * a->decay_mult;
-                        a->decay_type = 0;
+                        if (a->volts > a->pop_ratio * a->fast_backaverage) {
+                            a->state = 1;
+                            a->volts += (ring_max - a->volts) * a->fast_decay_mult;
+                        } else {
+                            if (a->hang_enable && (a->hang_backaverage > a->hang_level)) {
+                                a->state = 2;
+                                a->hang_counter = (int)(a->hangtime * a->sample_rate);
+                                a->decay_type = 1;
+                            } else {
+                                a->state = 3;
+                                a->volts += (ring_max - a->volts) * a->decay_mult;
+                                a->decay_type = 0;
+                            }
+                        }
                     }
-                }
-            }
-            break;
+                    break;
 
-        case 1:
-            if (a->ring_max >= a->volts) {
-                a->state = 0;
-                a->volts += (a->ring_max - a->volts) * a->attack_mult;
-            } else {
-                if (a->volts > a->save_volts) {
-                    a->volts += (a->ring_max - a->volts) * a->fast_decay_mult;
-                } else {
-                    if (a->hang_counter > 0) {
-                        a->state = 2;
+                case 1:
+                    if (ring_max >= a->volts) {
+                        a->state = 0;
+                        a->volts += (ring_max - a->volts) * a->attack_mult;
                     } else {
-                        if (a->decay_type == 0) {
-                            a->state = 3;
-                            a->volts += (a->ring_max - a->volts) * a->decay_mult;
+                        if (a->volts > a->save_volts) {
+                            a->volts += (ring_max - a->volts) * a->fast_decay_mult;
                         } else {
+                            if (a->hang_counter > 0) {
+                                a->state = 2;
+                            } else {
+                                if (a->decay_type == 0) {
+                                    a->state = 3;
+                                    a->volts += (ring_max - a->volts) * a->decay_mult;
+                                } else {
+                                    a->state = 4;
+                                    a->volts += (ring_max - a->volts) * a->hang_decay_mult;
+                                }
+                            }
+                        }
+                    }
+                    break;
+
+                case 2:
+                    if (ring_max >= a->volts) {
+                        a->state = 0;
+                        a->save_volts = a->volts;
+                        a->volts += (ring_max - a->volts) * a->attack_mult;
+                    } else {
+                        if (a->hang_counter == 0) {
                             a->state = 4;
-                            a->volts += (a->ring_max - a->volts) * a->hang_decay_mult;
+                            a->volts += (ring_max - a->volts) * a->hang_decay_mult;
                         }
                     }
-                }
-            }
-            break;
+                    break;
 
-        case 2:
-            if (a->ring_max >= a->volts) {
-                a->state = 0;
-                a->save_volts = a->volts;
-                a->volts += (a->ring_max - a->volts) * a->attack_mult;
-            } else {
-                if (a->hang_counter == 0) {
-                    a->state = 4;
-                    a->volts += (a->ring_max - a->volts) * a->hang_decay_mult;
-                }
+                case 3:
+                    if (ring_max >= a->volts) {
+                        a->state = 0;
+                        a->save_volts = a->volts;
+                        a->volts += (ring_max - a->volts) * a->attack_mult;
+                    } else {
+                        a->volts += (ring_max - a->volts) * a->decay_mult;
+                    }
+                    break;
+
+                case 4:
+                    if (ring_max >= a->volts) {
+                        a->state = 0;
+                        a->save_volts = a->volts;
+                        a->volts += (ring_max - a->volts) * a->attack_mult;
+                    } else {
+                        a->volts += (ring_max - a->volts) * a->hang_decay_mult;
+                    }
+                    break;
             }
-            break;
 
-        case 3:
-            if (a->ring_max >= a->volts) {
-                a->state = 0;
-                a->save_volts = a->volts;
-                a->volts += (a->ring_max - a->volts) * a->attack_mult;
-            } else {
-                a->volts += (a->ring_max - a->volts) * a->decay_mult;
+            if (a->volts < a->min_volts) {
+                a->volts = a->min_volts;
             }
-            break;
 
-        case 4:
-            if (a->ring_max >= a->volts) {
-                a->state = 0;
-                a->save_volts = a->volts;
-                a->volts += (a->ring_max - a->volts) * a->attack_mult;
-            } else {
-                a->volts += (a->ring_max - a->volts) * a->hang_decay_mult;
+            volts[i] = a->volts;
+        }
+
+        /* Volts often holds still, in hang and at the floor */
+
+        for (size_t i = 0; i < m; i++) {
+            if (volts[i] != last_volts) {
+                last_volts = volts[i];
+                mult = (a->out_target - a->slope_constant * fmin(0.0f, log10f(a->inv_max_input * last_volts))) / last_volts;
             }
-            break;
-    }
 
-    if (a->volts < a->min_volts) {
-        a->volts = a->min_volts;
+            out[i] = delayed[i] * mult;
+        }
+
+        a->ring_max = env[m - 1];
+        a->out_sample = delayed[m - 1];
+        a->abs_out_sample = leaving[m - 1];
+
+        in += m;
+        out += m;
+        n -= m;
     }
 
     a->gain = a->volts * a->inv_out_target;
-    mult = (a->out_target - a->slope_constant * fmin(0.0f, log10f(a->inv_max_input * a->volts))) / a->volts;
-
-    return a->out_sample * mult;
 }
 
 void agc_set_mode(agc_t *a, int mode) {
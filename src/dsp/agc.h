@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <stddef.h>
+
 typedef enum {
     AGC_OFF = 0,
     AGC_LONG,
@@ -49,6 +51,10 @@ typedef struct {
     int     ring_buffsize;
     float   ring_max;
 
+    float*  max_suffix; /* Attack window maximum, van Herk / Gil-Werman */
+    float   max_prefix;
+    int     max_offset;
+
     float   attack_mult;
     float   decay_mult;
     float   volts;
@@ -102,6 +108,7 @@ agc_t * agc_create(
 );
 
 float agc_apply(agc_t *a, float in);
+void agc_apply_block(agc_t *a, const float *in, float *out, size_t n);
 void agc_destroy(agc_t *a);
 void agc_flush(agc_t *a);
 void agc_set_mode(agc_t *a, int mode);
@@ -7,6 +7,7 @@
  */
 
 #include <math.h>
+#include <string.h>
 #include "biquad.h"
 
 float biqiad_apply(biquad_t *f, float x) {
@@ -21,6 +22,32 @@ float biqiad_apply(biquad_t *f, float x) {
     return y;
 }
 
+/* In place, with the state kept in registers for the whole block */
+
+void biquad_apply_block(biquad_t *f, float *buf, size_t n) {
+    float b0 = f->b0, b1 = f->b1, b2 = f->b2;
+    float a1 = f->a1, a2 = f->a2;
+    float x1 = f->x1, x2 = f->x2;
+    float y1 = f->y1, y2 = f->y2;
+
+    for (size_t i = 0; i < n; i++) {
+        float x = buf[i];
+        float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = y;
+
+        buf[i] = y;
+    }
+
+    f->x1 = x1;
+    f->x2 = x2;
+    f->y1 = y1;
+    f->y2 = y2;
+}
+
 void biquad_lpf(biquad_t *f, float f0, float q, float fs) {
     float w0 = 2.0f * M_PI * f0 / fs;
     float alpha = sinf(w0) / (2.0f * q);
@@ -60,3 +87,126 @@ void biquad_peak_eq(biquad_t *f, float f0, float q, float gain, float fs) {
     f->a1 = (-2.0f * cosw0) / a0;
     f->a2 = (1.0f - alpha/a) / a0;
 }
+
+/* Cascade */
+
+#define BIQUAD_FRESH    0x4
+#define BIQUAD_INDEX    0x3
+
+void biquad_cascade_init(biquad_cascade_t *c) {
+    memset(c, 0, sizeof(*c));
+
+    c->back = 0;
+    c->front = 1;
+    atomic_init(&c->middle, 2);
+}
+
+/* Producer. A peak EQ at 0 dB comes out as exactly b == a and is left out */
+
+void biquad_cascade_set(biquad_cascade_t *c, const biquad_t *sections, size_t n) {
+    biquad_coefs_t *coefs = &c->coefs[c->back];
+
+    coefs->count = 0;
+    coefs->mask = 0;
+
+    for (size_t i = 0; i < n && i < BIQUAD_CASCADE_MAX; i++) {
+        const biquad_t *f = &sections[i];
+
+        if (f->b0 == 1.0f && f->b1 == f->a1 && f->b2 == f->a2) {
+            continue;
+        }
+
+        uint8_t k = coefs->count++;
+
+        coefs->index[k] = i;
+        coefs->b0[k] = f->b0;
+        coefs->b1[k] = f->b1;
+        coefs->b2[k] = f->b2;
+        coefs->a1[k] = f->a1;
+        coefs->a2[k] = f->a2;
+        coefs->mask |= 1 << i;
+    }
+
+    c->back = atomic_exchange(&c->middle, c->back | BIQUAD_FRESH) & BIQUAD_INDEX;
+}
+
+/* All active sections per sample, so a section works on sample j while the next one is still on j - 1 */
+
+static inline void cascade_run(const biquad_coefs_t *coefs, float *s1, float *s2, float *buf, size_t n, const uint8_t count) {
+    float   b0[BIQUAD_CASCADE_MAX], b1[BIQUAD_CASCADE_MAX], b2[BIQUAD_CASCADE_MAX];
+    float   a1[BIQUAD_CASCADE_MAX], a2[BIQUAD_CASCADE_MAX];
+    float   z1[BIQUAD_CASCADE_MAX], z2[BIQUAD_CASCADE_MAX];
+
+    for (uint8_t k = 0; k < count; k++) {
+        b0[k] = coefs->b0[k];
+        b1[k] = coefs->b1[k];
+        b2[k] = coefs->b2[k];
+        a1[k] = coefs->a1[k];
+        a2[k] = coefs->a2[k];
+        z1[k] = s1[coefs->index[k]];
+        z2[k] = s2[coefs->index[k]];
+    }
+
+    for (size_t j = 0; j < n; j++) {
+        float x = buf[j];
+
+        for (uint8_t k = 0; k < count; k++) {
+            float y = b0[k] * x + z1[k];
+
+            z1[k] = b1[k] * x + z2[k] - a1[k] * y;
+            z2[k] = b2[k] * x - a2[k] * y;
+            x = y;
+        }
+
+        buf[j] = x;
+    }
+
+    for (uint8_t k = 0; k < count; k++) {
+        s1[coefs->index[k]] = z1[k];
+        s2[coefs->index[k]] = z2[k];
+    }
+}
+
+/* Consumer, in place. Flat sections cost nothing */
+
+void biquad_cascade_apply(biquad_cascade_t *c, float *buf, size_t n) {
+    if (atomic_load_explicit(&c->middle, memory_order_relaxed) & BIQUAD_FRESH) {
+        uint32_t prev = c->coefs[c->front].mask;
+
+        c->front = atomic_exchange(&c->middle, c->front) & BIQUAD_INDEX;
+
+        /* Sections coming out of bypass start from silence */
+
+        uint32_t fresh = c->coefs[c->front].mask & ~prev;
+
+        for (uint8_t i = 0; i < BIQUAD_CASCADE_MAX; i++) {
+            if (fresh & (1 << i)) {
+                c->s1[i] = 0.0f;
+                c->s2[i] = 0.0f;
+            }
+        }
+    }
+
+    const biquad_coefs_t *coefs = &c->coefs[c->front];
+
+    switch (coefs->count) {
+        case 0:
+            break;
+
+        case 1:
+            cascade_run(coefs, c->s1, c->s2, buf, n, 1);
+            break;
+
+        case 2:
+            cascade_run(coefs, c->s1, c->s2, buf, n, 2);
+            break;
+
+        case 3:
+            cascade_run(coefs, c->s1, c->s2, buf, n, 3);
+            break;
+
+        default:
+            cascade_run(coefs, c->s1, c->s2, buf, n, 4);
+            break;
+    }
+}
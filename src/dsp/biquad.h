@@ -3,11 +3,17 @@
  *
  *  TRX Brass LVGL GUI
  *
- *  Copyright (c) 2022-2024 Belousov Oleg aka R1CBU
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
  */
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define BIQUAD_CASCADE_MAX  4
+
 typedef struct {
     float   a1, a2;
     float   b0, b1, b2;
@@ -15,8 +21,37 @@ typedef struct {
     float   y1, y2;
 } biquad_t;
 
+/* Active sections only, one array per term. Laid out for 4-lane loads */
+
+typedef struct {
+    uint8_t     count;
+    uint8_t     index[BIQUAD_CASCADE_MAX];
+    uint32_t    mask;
+    float       b0[BIQUAD_CASCADE_MAX];
+    float       b1[BIQUAD_CASCADE_MAX];
+    float       b2[BIQUAD_CASCADE_MAX];
+    float       a1[BIQUAD_CASCADE_MAX];
+    float       a2[BIQUAD_CASCADE_MAX];
+} biquad_coefs_t;
+
+/* Set by one thread, applied by another. Coefficients go through a triple buffer */
+
+typedef struct {
+    biquad_coefs_t  coefs[3];
+    uint8_t         back;
+    uint8_t         front;
+    atomic_uint     middle;
+    float           s1[BIQUAD_CASCADE_MAX];     /* Transposed DF-II state, per section */
+    float           s2[BIQUAD_CASCADE_MAX];
+} biquad_cascade_t;
+
 float biqiad_apply(biquad_t *f, float x);
+void biquad_apply_block(biquad_t *f, float *buf, size_t n);
 
 void biquad_lpf(biquad_t *f, float f0, float q, float fs);
 void biquad_hpf(biquad_t *f, float f0, float q, float fs);
 void biquad_peak_eq(biquad_t *f, float f0, float q, float gain, float fs);
+
+void biquad_cascade_init(biquad_cascade_t *c);
+void biquad_cascade_set(biquad_cascade_t *c, const biquad_t *sections, size_t n);
+void biquad_cascade_apply(biquad_cascade_t *c, float *buf, size_t n);
@@ -0,0 +1,24 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ *
+ *  Based on WDSP lib
+ *  Copyright (C) 2011 - 2017 Warren Pratt, NR0V
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define EMNR_KEY_SIZE   241
+
+typedef struct {
+    float       scale;
+    uint16_t    data[EMNR_KEY_SIZE * EMNR_KEY_SIZE];
+} emnr_key_t;
+
+extern const emnr_key_t GG;
+extern const emnr_key_t GGS;
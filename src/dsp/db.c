@@ -0,0 +1,173 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <string.h>
+#include "db.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* 10 * log10(2) */
+
+#define DB_LOG2     3.01029995663981f
+
+/* log2(m) on [1, 2) */
+
+#define C0  -2.79415368f
+#define C1   5.06975632f
+#define C2  -3.52021884f
+#define C3   1.61017755f
+#define C4  -0.409475586f
+#define C5   0.0439286278f
+
+static inline float db_scalar(float x, float offset, float floor) {
+    uint32_t bits;
+
+    if (!(x > 0.0f)) {
+        return floor;
+    }
+
+    memcpy(&bits, &x, sizeof(bits));
+
+    float   e = (float) ((int32_t) (bits >> 23) - 127);
+    float   m;
+
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+    memcpy(&m, &bits, sizeof(m));
+
+    float p = ((((C5 * m + C4) * m + C3) * m + C2) * m + C1) * m + C0;
+
+    return (e + p) * DB_LOG2 + offset;
+}
+
+static inline uint8_t index_scalar(float db, float min, float k) {
+    float v = (db - min) * k;
+
+    if (v < 0.0f) {
+        v = 0.0f;
+    } else if (v > 255.0f) {
+        v = 255.0f;
+    }
+
+    return (uint8_t) v;
+}
+
+#if defined(__ARM_NEON)
+
+static inline float32x4_t db_vector(float32x4_t x, float32x4_t offset, float32x4_t floor) {
+    int32x4_t   bits = vreinterpretq_s32_f32(x);
+    float32x4_t e = vcvtq_f32_s32(vsubq_s32(vshrq_n_s32(bits, 23), vdupq_n_s32(127)));
+    float32x4_t m = vreinterpretq_f32_s32(vorrq_s32(vandq_s32(bits, vdupq_n_s32(0x007FFFFF)), vdupq_n_s32(0x3F800000)));
+    float32x4_t p = vdupq_n_f32(C5);
+
+    p = vmlaq_f32(vdupq_n_f32(C4), p, m);
+    p = vmlaq_f32(vdupq_n_f32(C3), p, m);
+    p = vmlaq_f32(vdupq_n_f32(C2), p, m);
+    p = vmlaq_f32(vdupq_n_f32(C1), p, m);
+    p = vmlaq_f32(vdupq_n_f32(C0), p, m);
+
+    float32x4_t y = vmlaq_f32(offset, vaddq_f32(e, p), vdupq_n_f32(DB_LOG2));
+
+    return vbslq_f32(vcgtq_f32(x, vdupq_n_f32(0.0f)), y, floor);
+}
+
+#elif defined(__SSE2__)
+
+static inline __m128 db_vector(__m128 x, __m128 offset, __m128 floor) {
+    __m128i bits = _mm_castps_si128(x);
+    __m128  e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    __m128  m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+    __m128  p = _mm_set1_ps(C5);
+
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(C4));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(C3));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(C2));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(C1));
+    p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(C0));
+
+    __m128  y = _mm_add_ps(_mm_mul_ps(_mm_add_ps(e, p), _mm_set1_ps(DB_LOG2)), offset);
+    __m128  mask = _mm_cmpgt_ps(x, _mm_setzero_ps());
+
+    return _mm_or_ps(_mm_and_ps(mask, y), _mm_andnot_ps(mask, floor));
+}
+
+#endif
+
+void db_from_power(const float *power, float *db, size_t n, float offset, float floor) {
+    size_t i = 0;
+
+#if defined(__ARM_NEON)
+    float32x4_t voffset = vdupq_n_f32(offset);
+    float32x4_t vfloor = vdupq_n_f32(floor);
+
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(db + i, db_vector(vld1q_f32(power + i), voffset, vfloor));
+    }
+#elif defined(__SSE2__)
+    __m128      voffset = _mm_set1_ps(offset);
+    __m128      vfloor = _mm_set1_ps(floor);
+
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(db + i, db_vector(_mm_loadu_ps(power + i), voffset, vfloor));
+    }
+#endif
+
+    for (; i < n; i++) {
+        db[i] = db_scalar(power[i], offset, floor);
+    }
+}
+
+void db_index_from_power(const float *power, uint8_t *index, size_t n, float offset, float min, float max) {
+    float   k = 255.0f / (max - min);
+    size_t  i = 0;
+
+#if defined(__ARM_NEON)
+    float32x4_t voffset = vdupq_n_f32(offset);
+    float32x4_t vmin = vdupq_n_f32(min);
+    float32x4_t vk = vdupq_n_f32(k);
+    float32x4_t vhi = vdupq_n_f32(255.0f);
+    float32x4_t vzero = vdupq_n_f32(0.0f);
+
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vmulq_f32(vsubq_f32(db_vector(vld1q_f32(power + i), voffset, vmin), vmin), vk);
+        float32x4_t b = vmulq_f32(vsubq_f32(db_vector(vld1q_f32(power + i + 4), voffset, vmin), vmin), vk);
+
+        a = vminq_f32(vmaxq_f32(a, vzero), vhi);
+        b = vminq_f32(vmaxq_f32(b, vzero), vhi);
+
+        uint16x8_t w = vcombine_u16(vmovn_u32(vcvtq_u32_f32(a)), vmovn_u32(vcvtq_u32_f32(b)));
+
+        vst1_u8(index + i, vmovn_u16(w));
+    }
+#elif defined(__SSE2__)
+    __m128      voffset = _mm_set1_ps(offset);
+    __m128      vmin = _mm_set1_ps(min);
+    __m128      vk = _mm_set1_ps(k);
+    __m128      vhi = _mm_set1_ps(255.0f);
+    __m128      vzero = _mm_setzero_ps();
+
+    for (; i + 8 <= n; i += 8) {
+        __m128  a = _mm_mul_ps(_mm_sub_ps(db_vector(_mm_loadu_ps(power + i), voffset, vmin), vmin), vk);
+        __m128  b = _mm_mul_ps(_mm_sub_ps(db_vector(_mm_loadu_ps(power + i + 4), voffset, vmin), vmin), vk);
+
+        a = _mm_min_ps(_mm_max_ps(a, vzero), vhi);
+        b = _mm_min_ps(_mm_max_ps(b, vzero), vhi);
+
+        __m128i w = _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b));
+
+        _mm_storel_epi64((__m128i *) (index + i), _mm_packus_epi16(w, w));
+    }
+#endif
+
+    for (; i < n; i++) {
+        index[i] = index_scalar(db_scalar(power[i], offset, min), min, k);
+    }
+}
@@ -0,0 +1,23 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Power to dB over whole arrays, about 5e-5 dB off log10f. Bins with no
+ * power get floor. in and out may be the same buffer
+ */
+
+void db_from_power(const float *power, float *db, size_t n, float offset, float floor);
+
+/* Power to dB, then (dB - min) / (max - min) scaled to a 0..255 palette index */
+
+void db_index_from_power(const float *power, uint8_t *index, size_t n, float offset, float min, float max);
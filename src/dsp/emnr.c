@@ -13,15 +13,25 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <math.h>
+#include <float.h>
 #include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
 
+#include "lvgl/lvgl.h"
 #include "emnr.h"
 #include "zeta_hat.h"
 
-extern double GG[];
-extern double GGS[];
+#define EMNR_HUGE       FLT_MAX
+#define EMNR_TINY       FLT_MIN
+#define EMNR_EXP_MAX    80.0f   /* expf() overflows past 88 */
 
-typedef double complex[2];
+#define EMNR_WISDOM     "/mnt/settings/emnr.wisdom"
+
+static pthread_mutex_t  plan_mux = PTHREAD_MUTEX_INITIALIZER;
+static bool             wisdom_loaded = false;
+
+typedef float  complex[2];
 
 /********************************************************************************************************
  *																										*
@@ -36,67 +46,67 @@ typedef double complex[2];
 //      Inc., 1996.  [Sample code given in FORTRAN]
 
 
-double bessI0(double x) {
-    double res, p;
+float bessI0(float x) {
+    float res, p;
 
-    if (x == 0.0) {
-        res = 1.0;
+    if (x == 0.0f) {
+        res = 1.0f;
     } else {
-        if (x < 0.0) {
+        if (x < 0.0f) {
             x = -x;
         }
 
-        if (x <= 3.75) {
-            p   = x / 3.75;
+        if (x <= 3.75f) {
+            p   = x / 3.75f;
             p   = p * p;
-            res = (((((0.0045813 * p + 0.0360768) * p + 0.2659732) * p + 1.2067492) * p + 3.0899424) * p + 3.5156229) *
+            res = (((((0.0045813f * p + 0.0360768f) * p + 0.2659732f) * p + 1.2067492f) * p + 3.0899424f) * p + 3.5156229f) *
                       p +
-                  1.0;
+                  1.0f;
         } else {
-            p   = 3.75 / x;
-            res = exp(x) / sqrt(x) *
-                  ((((((((+0.00392377 * p - 0.01647633) * p + 0.02635537) * p - 0.02057706) * p + 0.00916281) * p -
-                      0.00157565) *
+            p   = 3.75f / x;
+            res = expf(x) / sqrtf(x) *
+                  ((((((((+0.00392377f * p - 0.01647633f) * p + 0.02635537f) * p - 0.02057706f) * p + 0.00916281f) * p -
+                      0.00157565f) *
                          p +
-                     0.00225319) *
+                     0.00225319f) *
                         p +
-                    0.01328592) *
+                    0.01328592f) *
                        p +
-                   0.39894228);
+                   0.39894228f);
         }
     }
 
     return res;
 }
 
-double bessI1(double x) {
-    double res, p;
+float bessI1(float x) {
+    float res, p;
 
-    if (x == 0.0) {
-        res = 0.0;
+    if (x == 0.0f) {
+        res = 0.0f;
     } else {
-        if (x < 0.0) {
+        if (x < 0.0f) {
             x = -x;
         }
 
-        if (x <= 3.75) {
-            p   = x / 3.75;
+        if (x <= 3.75f) {
+            p   = x / 3.75f;
             p   = p * p;
-            res = x * ((((((0.00032411 * p + 0.00301532) * p + 0.02658733) * p + 0.15084934) * p + 0.51498869) * p +
-                        0.87890594) *
+            res = x * ((((((0.00032411f * p + 0.00301532f) * p + 0.02658733f) * p + 0.15084934f) * p + 0.51498869f) * p +
+                        0.87890594f) *
                            p +
-                       0.5);
+                       0.5f);
         } else {
-            p   = 3.75 / x;
-            res = exp(x) / sqrt(x) *
-                  ((((((((-0.00420059 * p + 0.01787654) * p - 0.02895312) * p + 0.02282967) * p - 0.01031555) * p +
-                      0.00163801) *
+            p   = 3.75f / x;
+            res = expf(x) / sqrtf(x) *
+                  ((((((((-0.00420059f * p + 0.01787654f) * p - 0.02895312f) * p + 0.02282967f) * p - 0.01031555f) * p +
+                      0.00163801f) *
                          p -
-                     0.00362018) *
+                     0.00362018f) *
                         p -
-                    0.03988024) *
+                    0.03988024f) *
                        p +
-                   0.39894228);
+                   0.39894228f);
         }
     }
 
@@ -109,36 +119,36 @@ double bessI1(double x) {
 // Shanjie Zhang and Jianming Jin, "Computation of Special Functions."  New York, NY, John Wiley and Sons,
 //      Inc., 1996.  [Sample code given in FORTRAN]
 
-double e1xb(double x) {
-    double e1, ga, r, t, t0;
+float e1xb(float x) {
+    float e1, ga, r, t, t0;
     int    k, m;
 
-    if (x == 0.0) {
-        e1 = 1.0e300;
-    } else if (x <= 1.0) {
-        e1 = 1.0;
-        r  = 1.0;
+    if (x == 0.0f) {
+        e1 = EMNR_HUGE;
+    } else if (x <= 1.0f) {
+        e1 = 1.0f;
+        r  = 1.0f;
 
         for (k = 1; k <= 25; k++) {
-            r  = -r * k * x / ((k + 1.0) * (k + 1.0));
+            r  = -r * k * x / ((k + 1.0f) * (k + 1.0f));
             e1 = e1 + r;
-            if (fabs(r) <= fabs(e1) * 1.0e-15) {
+            if (fabsf(r) <= fabsf(e1) * 1.0e-7f) {
                 break;
             }
         }
 
-        ga = 0.5772156649015328;
-        e1 = -ga - log(x) + x * e1;
+        ga = 0.5772156649015328f;
+        e1 = -ga - logf(x) + x * e1;
     } else {
-        m  = 20 + (int) (80.0 / x);
-        t0 = 0.0;
+        m  = 20 + (int) (80.0f / x);
+        t0 = 0.0f;
 
         for (k = m; k >= 1; k--) {
-            t0 = (double) k / (1.0 + k / (x + t0));
+            t0 = (float) k / (1.0f + k / (x + t0));
         }
 
-        t  = 1.0 / (x + t0);
-        e1 = exp(-x) * t;
+        t  = 1.0f / (x + t0);
+        e1 = expf(-x) * t;
     }
 
     return e1;
@@ -152,19 +162,19 @@ double e1xb(double x) {
 
 void calc_window(emnr_t *a) {
     int    i;
-    double arg, sum, inv_coherent_gain;
+    float arg, sum, inv_coherent_gain;
 
     switch (a->wintype) {
         case 0:
-            arg = 2.0 * M_PI / (double) a->fsize;
-            sum = 0.0;
+            arg = 2.0f * M_PI / (float) a->fsize;
+            sum = 0.0f;
 
             for (i = 0; i < a->fsize; i++) {
-                a->window[i] = sqrt(0.54 - 0.46 * cos((double) i * arg));
+                a->window[i] = sqrtf(0.54f - 0.46f * cosf((float) i * arg));
                 sum += a->window[i];
             }
 
-            inv_coherent_gain = (double) a->fsize / sum;
+            inv_coherent_gain = (float) a->fsize / sum;
 
             for (i = 0; i < a->fsize; i++) {
                 a->window[i] *= inv_coherent_gain;
@@ -173,37 +183,81 @@ void calc_window(emnr_t *a) {
     }
 }
 
-void interpM(double *res, double x, int nvals, double *xvals, double *yvals) {
+void interpM(float *res, float x, int nvals, float *xvals, float *yvals) {
     if (x <= xvals[0]) {
         *res = yvals[0];
     } else if (x >= xvals[nvals - 1]) {
         *res = yvals[nvals - 1];
     } else {
         int    idx = 0;
-        double xllow, xlhigh, frac;
+        float xllow, xlhigh, frac;
 
         while (x >= xvals[idx]) {
             idx++;
         }
 
-        xllow  = log10(xvals[idx - 1]);
-        xlhigh = log10(xvals[idx]);
-        frac   = (log10(x) - xllow) / (xlhigh - xllow);
+        xllow  = log10f(xvals[idx - 1]);
+        xlhigh = log10f(xvals[idx]);
+        frac   = (log10f(x) - xllow) / (xlhigh - xllow);
         *res   = yvals[idx - 1] + frac * (yvals[idx] - yvals[idx - 1]);
     }
 }
 
+/*
+ * FFTW_MEASURE takes seconds on the radio, so it is done once per size and
+ * kept as wisdom. Planning runs before the buffers hold anything, it
+ * overwrites them
+ */
+
+static void make_plans(emnr_t *a) {
+    pthread_mutex_lock(&plan_mux);
+
+    if (!wisdom_loaded) {
+        wisdom_loaded = true;
+
+        if (!fftwf_import_wisdom_from_filename(EMNR_WISDOM)) {
+            LV_LOG_INFO("No EMNR wisdom yet");
+        }
+    }
+
+    unsigned flags = FFTW_MEASURE | FFTW_WISDOM_ONLY;
+
+    a->Rfor = fftwf_plan_dft_r2c_1d(a->fsize, a->forfftin, (fftwf_complex *) a->forfftout, flags);
+    a->Rrev = fftwf_plan_dft_c2r_1d(a->fsize, (fftwf_complex *) a->revfftin, a->revfftout, flags);
+
+    if (!a->Rfor || !a->Rrev) {
+        LV_LOG_INFO("Measuring EMNR FFT of %i", a->fsize);
+
+        if (a->Rfor) {
+            fftwf_destroy_plan(a->Rfor);
+        }
+
+        if (a->Rrev) {
+            fftwf_destroy_plan(a->Rrev);
+        }
+
+        a->Rfor = fftwf_plan_dft_r2c_1d(a->fsize, a->forfftin, (fftwf_complex *) a->forfftout, FFTW_MEASURE);
+        a->Rrev = fftwf_plan_dft_c2r_1d(a->fsize, (fftwf_complex *) a->revfftin, a->revfftout, FFTW_MEASURE);
+
+        if (!fftwf_export_wisdom_to_filename(EMNR_WISDOM)) {
+            LV_LOG_WARN("Unable to save EMNR wisdom");
+        }
+    }
+
+    pthread_mutex_unlock(&plan_mux);
+}
+
 void calc_emnr(emnr_t *a) {
     int    i;
-    double Dvals[18] = {1.0,  2.0,  5.0,   8.0,   10.0,  15.0,  20.0,  30.0,  40.0,
-                        60.0, 80.0, 120.0, 140.0, 160.0, 180.0, 220.0, 260.0, 300.0};
-    double Mvals[18] = {0.000, 0.260, 0.480, 0.580, 0.610, 0.668, 0.705, 0.762, 0.800,
-                        0.841, 0.865, 0.890, 0.900, 0.910, 0.920, 0.930, 0.935, 0.940};
-    double Hvals[18] = {0.000, 0.150, 0.480, 0.780, 0.980, 1.550, 2.000, 2.300, 2.520,
-                        3.100, 3.380, 4.150, 4.350, 4.250, 3.900, 4.100, 4.700, 5.000};
+    float Dvals[18] = {1.0f,  2.0f,  5.0f,   8.0f,   10.0f,  15.0f,  20.0f,  30.0f,  40.0f,
+                       60.0f, 80.0f, 120.0f, 140.0f, 160.0f, 180.0f, 220.0f, 260.0f, 300.0f};
+    float Mvals[18] = {0.000f, 0.260f, 0.480f, 0.580f, 0.610f, 0.668f, 0.705f, 0.762f, 0.800f,
+                       0.841f, 0.865f, 0.890f, 0.900f, 0.910f, 0.920f, 0.930f, 0.935f, 0.940f};
+    float Hvals[18] = {0.000f, 0.150f, 0.480f, 0.780f, 0.980f, 1.550f, 2.000f, 2.300f, 2.520f,
+                       3.100f, 3.380f, 4.150f, 4.350f, 4.250f, 3.900f, 4.100f, 4.700f, 5.000f};
 
     a->incr          = a->fsize / a->ovrlp;
-    a->gain          = a->ogain / a->fsize / (double) a->ovrlp;
+    a->gain          = a->ogain / a->fsize / (float) a->ovrlp;
 
     if (a->fsize > a->bsize) {
         a->iasize = a->fsize;
@@ -229,24 +283,23 @@ void calc_emnr(emnr_t *a) {
     a->init_oainidx = a->oainidx;
     a->oaoutidx     = 0;
     a->msize        = a->fsize / 2 + 1;
-    a->window       = (double *) calloc(a->fsize, sizeof(double));
+    a->window       = (float *) calloc(a->fsize, sizeof(float));
     a->inaccum      = (float *) calloc(a->iasize, sizeof(float));
-    a->forfftin     = (double *) calloc(a->fsize, sizeof(double));
-    a->forfftout    = (double *) calloc(a->msize, sizeof(complex));
-    a->mask         = (double *) calloc(a->msize, sizeof(double));
-    a->revfftin     = (double *) calloc(a->msize, sizeof(complex));
-    a->revfftout    = (double *) calloc(a->fsize, sizeof(double));
-    a->save         = (double **) calloc(a->ovrlp, sizeof(double *));
+    a->forfftin     = (float *) calloc(a->fsize, sizeof(float));
+    a->forfftout    = (float *) calloc(a->msize, sizeof(complex));
+    a->mask         = (float *) calloc(a->msize, sizeof(float));
+    a->revfftin     = (float *) calloc(a->msize, sizeof(complex));
+    a->revfftout    = (float *) calloc(a->fsize, sizeof(float));
+    a->save         = (float **) calloc(a->ovrlp, sizeof(float *));
 
     for (i = 0; i < a->ovrlp; i++) {
-        a->save[i] = (double *) calloc(a->fsize, sizeof(double));
+        a->save[i] = (float *) calloc(a->fsize, sizeof(float));
     }
 
-    a->outaccum = (double *) calloc(a->oasize, sizeof(double));
+    a->outaccum = (float *) calloc(a->oasize, sizeof(float));
     a->nsamps   = 0;
     a->saveidx  = 0;
-    a->Rfor     = fftw_plan_dft_r2c_1d(a->fsize, a->forfftin, (fftw_complex *) a->forfftout, FFTW_ESTIMATE);
-    a->Rrev     = fftw_plan_dft_c2r_1d(a->fsize, (fftw_complex *) a->revfftin, a->revfftout, FFTW_ESTIMATE);
+    make_plans(a);
     calc_window(a);
 
     /* g */
@@ -254,33 +307,33 @@ void calc_emnr(emnr_t *a) {
     a->g.msize      = a->msize;
     a->g.mask       = a->mask;
     a->g.y          = a->forfftout;
-    a->g.lambda_y   = (double *) calloc(a->msize, sizeof(double));
-    a->g.lambda_d   = (double *) calloc(a->msize, sizeof(double));
-    a->g.prev_gamma = (double *) calloc(a->msize, sizeof(double));
-    a->g.prev_mask  = (double *) calloc(a->msize, sizeof(double));
+    a->g.lambda_y   = (float *) calloc(a->msize, sizeof(float));
+    a->g.lambda_d   = (float *) calloc(a->msize, sizeof(float));
+    a->g.prev_gamma = (float *) calloc(a->msize, sizeof(float));
+    a->g.prev_mask  = (float *) calloc(a->msize, sizeof(float));
 
-    a->g.gf1p5      = sqrt(M_PI) / 2.0;
+    a->g.gf1p5      = sqrtf(M_PI) / 2.0f;
     {
-        double tau = -128.0 / 8000.0 / log(0.985);
-        a->g.alpha = exp(-a->incr / a->rate / tau);
+        float tau = -128.0f / 8000.0f / logf(0.985f);
+        a->g.alpha = expf(-a->incr / a->rate / tau);
     }
-    a->g.eps_floor = 1.0e-300;
-    a->g.gamma_max = 40.0;
-    a->g.xi_min    = pow(10.0, -40.0 / 10.0);
-    a->g.q         = 0.2;
+    a->g.eps_floor = EMNR_TINY;
+    a->g.gamma_max = 40.0f;
+    a->g.xi_min    = powf(10.0f, -40.0f / 10.0f);
+    a->g.q         = 0.2f;
 
     for (i = 0; i < a->g.msize; i++) {
-        a->g.prev_mask[i]  = 1.0;
-        a->g.prev_gamma[i] = 1.0;
+        a->g.prev_mask[i]  = 1.0f;
+        a->g.prev_gamma[i] = 1.0f;
     }
 
-    a->g.gmax = 10000.0;
+    a->g.gmax = 10000.0f;
 
     /* * */
 
-    a->g.GG = GG;
-    a->g.GGS = GGS;
-    a->g.zeta_thresh = -5.0;
+    a->g.GG = &GG;
+    a->g.GGS = &GGS;
+    a->g.zeta_thresh = -5.0f;
 
     /* np */
 
@@ -290,98 +343,98 @@ void calc_emnr(emnr_t *a) {
     a->np.lambda_y = a->g.lambda_y;
     a->np.lambda_d = a->g.lambda_d;
 
-    double tau;
+    float tau;
 
-    tau         = -128.0 / 8000.0 / log(0.7);
-    a->np.alphaCsmooth = exp(-a->np.incr / a->np.rate / tau);
+    tau         = -128.0f / 8000.0f / logf(0.7f);
+    a->np.alphaCsmooth = expf(-a->np.incr / a->np.rate / tau);
 
-    tau     = -128.0 / 8000.0 / log(0.96);
-    a->np.alphaMax = exp(-a->np.incr / a->np.rate / tau);
+    tau     = -128.0f / 8000.0f / logf(0.96f);
+    a->np.alphaMax = expf(-a->np.incr / a->np.rate / tau);
 
-    tau      = -128.0 / 8000.0 / log(0.7);
-    a->np.alphaCmin = exp(-a->np.incr / a->np.rate / tau);
+    tau      = -128.0f / 8000.0f / logf(0.7f);
+    a->np.alphaCmin = expf(-a->np.incr / a->np.rate / tau);
 
-    tau               = -128.0 / 8000.0 / log(0.3);
-    a->np.alphaMin_max_value = exp(-a->np.incr / a->np.rate / tau);
-    a->np.snrq = -a->np.incr / (0.064 * a->np.rate);
+    tau               = -128.0f / 8000.0f / logf(0.3f);
+    a->np.alphaMin_max_value = expf(-a->np.incr / a->np.rate / tau);
+    a->np.snrq = -a->np.incr / (0.064f * a->np.rate);
 
-    tau    = -128.0 / 8000.0 / log(0.8);
-    a->np.betamax = exp(-a->np.incr / a->np.rate / tau);
+    tau    = -128.0f / 8000.0f / logf(0.8f);
+    a->np.betamax = expf(-a->np.incr / a->np.rate / tau);
 
-    a->np.invQeqMax = 0.5;
-    a->np.av        = 2.12;
-    a->np.Dtime     = 8.0 * 12.0 * 128.0 / 8000.0;
+    a->np.invQeqMax = 0.5f;
+    a->np.av        = 2.12f;
+    a->np.Dtime     = 8.0f * 12.0f * 128.0f / 8000.0f;
     a->np.U         = 8;
-    a->np.V         = (int) (0.5 + (a->np.Dtime * a->np.rate / (a->np.U * a->np.incr)));
+    a->np.V         = (int) (0.5f + (a->np.Dtime * a->np.rate / (a->np.U * a->np.incr)));
 
     if (a->np.V < 4) {
         a->np.V = 4;
     }
 
-    if ((a->np.U = (int) (0.5 + (a->np.Dtime * a->np.rate / (a->np.V * a->np.incr)))) < 1) {
+    if ((a->np.U = (int) (0.5f + (a->np.Dtime * a->np.rate / (a->np.V * a->np.incr)))) < 1) {
         a->np.U = 1;
     }
 
     a->np.D = a->np.U * a->np.V;
     interpM(&a->np.MofD, a->np.D, 18, Dvals, Mvals);
     interpM(&a->np.MofV, a->np.V, 18, Dvals, Mvals);
-    a->np.invQbar_points[0] = 0.03;
-    a->np.invQbar_points[1] = 0.05;
-    a->np.invQbar_points[2] = 0.06;
-    a->np.invQbar_points[3] = 1.0e300;
-
-    double db;
-
-    db             = 10.0 * log10(8.0) / (12.0 * 128 / 8000);
-    a->np.nsmax[0] = pow(10.0, db / 10.0 * a->np.V * a->np.incr / a->np.rate);
-    db             = 10.0 * log10(4.0) / (12.0 * 128 / 8000);
-    a->np.nsmax[1] = pow(10.0, db / 10.0 * a->np.V * a->np.incr / a->np.rate);
-    db             = 10.0 * log10(2.0) / (12.0 * 128 / 8000);
-    a->np.nsmax[2] = pow(10.0, db / 10.0 * a->np.V * a->np.incr / a->np.rate);
-    db             = 10.0 * log10(1.2) / (12.0 * 128 / 8000);
-    a->np.nsmax[3] = pow(10.0, db / 10.0 * a->np.V * a->np.incr / a->np.rate);
-
-    a->np.p           = (double *) calloc(a->np.msize, sizeof(double));
-    a->np.alphaOptHat = (double *) calloc(a->np.msize, sizeof(double));
-    a->np.alphaHat    = (double *) calloc(a->np.msize, sizeof(double));
-    a->np.sigma2N     = (double *) calloc(a->np.msize, sizeof(double));
-    a->np.pbar        = (double *) calloc(a->np.msize, sizeof(double));
-    a->np.p2bar       = (double *) calloc(a->np.msize, sizeof(double));
-    a->np.Qeq         = (double *) calloc(a->np.msize, sizeof(double));
-    a->np.bmin        = (double *) calloc(a->np.msize, sizeof(double));
-    a->np.bmin_sub    = (double *) calloc(a->np.msize, sizeof(double));
+    a->np.invQbar_points[0] = 0.03f;
+    a->np.invQbar_points[1] = 0.05f;
+    a->np.invQbar_points[2] = 0.06f;
+    a->np.invQbar_points[3] = EMNR_HUGE;
+
+    float db;
+
+    db             = 10.0f * log10f(8.0f) / (12.0f * 128 / 8000);
+    a->np.nsmax[0] = powf(10.0f, db / 10.0f * a->np.V * a->np.incr / a->np.rate);
+    db             = 10.0f * log10f(4.0f) / (12.0f * 128 / 8000);
+    a->np.nsmax[1] = powf(10.0f, db / 10.0f * a->np.V * a->np.incr / a->np.rate);
+    db             = 10.0f * log10f(2.0f) / (12.0f * 128 / 8000);
+    a->np.nsmax[2] = powf(10.0f, db / 10.0f * a->np.V * a->np.incr / a->np.rate);
+    db             = 10.0f * log10f(1.2f) / (12.0f * 128 / 8000);
+    a->np.nsmax[3] = powf(10.0f, db / 10.0f * a->np.V * a->np.incr / a->np.rate);
+
+    a->np.p           = (float *) calloc(a->np.msize, sizeof(float));
+    a->np.alphaOptHat = (float *) calloc(a->np.msize, sizeof(float));
+    a->np.alphaHat    = (float *) calloc(a->np.msize, sizeof(float));
+    a->np.sigma2N     = (float *) calloc(a->np.msize, sizeof(float));
+    a->np.pbar        = (float *) calloc(a->np.msize, sizeof(float));
+    a->np.p2bar       = (float *) calloc(a->np.msize, sizeof(float));
+    a->np.Qeq         = (float *) calloc(a->np.msize, sizeof(float));
+    a->np.bmin        = (float *) calloc(a->np.msize, sizeof(float));
+    a->np.bmin_sub    = (float *) calloc(a->np.msize, sizeof(float));
     a->np.k_mod       = (int *) calloc(a->np.msize, sizeof(int));
-    a->np.actmin      = (double *) calloc(a->np.msize, sizeof(double));
-    a->np.actmin_sub  = (double *) calloc(a->np.msize, sizeof(double));
+    a->np.actmin      = (float *) calloc(a->np.msize, sizeof(float));
+    a->np.actmin_sub  = (float *) calloc(a->np.msize, sizeof(float));
     a->np.lmin_flag   = (int *) calloc(a->np.msize, sizeof(int));
-    a->np.pmin_u      = (double *) calloc(a->np.msize, sizeof(double));
-    a->np.actminbuff  = (double **) calloc(a->np.U, sizeof(double *));
+    a->np.pmin_u      = (float *) calloc(a->np.msize, sizeof(float));
+    a->np.actminbuff  = (float **) calloc(a->np.U, sizeof(float *));
 
     for (i = 0; i < a->np.U; i++) {
-        a->np.actminbuff[i] = (double *) calloc(a->np.msize, sizeof(double));
+        a->np.actminbuff[i] = (float *) calloc(a->np.msize, sizeof(float));
     }
 
     {
         int k, ku;
-        a->np.alphaC  = 1.0;
+        a->np.alphaC  = 1.0f;
         a->np.subwc   = a->np.V;
         a->np.amb_idx = 0;
 
         for (k = 0; k < a->np.msize; k++) {
-            a->np.lambda_y[k] = 0.5;
+            a->np.lambda_y[k] = 0.5f;
         }
 
-        memcpy(a->np.p, a->np.lambda_y, a->np.msize * sizeof(double));
-        memcpy(a->np.sigma2N, a->np.lambda_y, a->np.msize * sizeof(double));
-        memcpy(a->np.pbar, a->np.lambda_y, a->np.msize * sizeof(double));
-        memcpy(a->np.pmin_u, a->np.lambda_y, a->np.msize * sizeof(double));
+        memcpy(a->np.p, a->np.lambda_y, a->np.msize * sizeof(float));
+        memcpy(a->np.sigma2N, a->np.lambda_y, a->np.msize * sizeof(float));
+        memcpy(a->np.pbar, a->np.lambda_y, a->np.msize * sizeof(float));
+        memcpy(a->np.pmin_u, a->np.lambda_y, a->np.msize * sizeof(float));
 
         for (k = 0; k < a->np.msize; k++) {
             a->np.p2bar[k]      = a->np.lambda_y[k] * a->np.lambda_y[k];
-            a->np.actmin[k]     = 1.0e300;
-            a->np.actmin_sub[k] = 1.0e300;
+            a->np.actmin[k]     = EMNR_HUGE;
+            a->np.actmin_sub[k] = EMNR_HUGE;
             for (ku = 0; ku < a->np.U; ku++) {
-                a->np.actminbuff[ku][k] = 1.0e300;
+                a->np.actminbuff[ku][k] = EMNR_HUGE;
             }
         }
         memset(a->np.lmin_flag, 0, a->np.msize * sizeof(int));
@@ -395,23 +448,23 @@ void calc_emnr(emnr_t *a) {
     a->nps.lambda_y = a->g.lambda_y;
     a->nps.lambda_d = a->g.lambda_d;
 
-    tau       = -128.0 / 8000.0 / log(0.8);
-    a->nps.alpha_pow = exp(-a->nps.incr / a->nps.rate / tau);
+    tau       = -128.0f / 8000.0f / logf(0.8f);
+    a->nps.alpha_pow = expf(-a->nps.incr / a->nps.rate / tau);
 
-    tau        = -128.0 / 8000.0 / log(0.9);
-    a->nps.alpha_Pbar = exp(-a->nps.incr / a->nps.rate / tau);
+    tau        = -128.0f / 8000.0f / logf(0.9f);
+    a->nps.alpha_Pbar = expf(-a->nps.incr / a->nps.rate / tau);
 
-    a->nps.epsH1   = pow(10.0, 15.0 / 10.0);
-    a->nps.epsH1r  = a->nps.epsH1 / (1.0 + a->nps.epsH1);
+    a->nps.epsH1   = powf(10.0f, 15.0f / 10.0f);
+    a->nps.epsH1r  = a->nps.epsH1 / (1.0f + a->nps.epsH1);
 
-    a->nps.sigma2N = (double *) calloc(a->nps.msize, sizeof(double));
-    a->nps.PH1y    = (double *) calloc(a->nps.msize, sizeof(double));
-    a->nps.Pbar    = (double *) calloc(a->nps.msize, sizeof(double));
-    a->nps.EN2y    = (double *) calloc(a->nps.msize, sizeof(double));
+    a->nps.sigma2N = (float *) calloc(a->nps.msize, sizeof(float));
+    a->nps.PH1y    = (float *) calloc(a->nps.msize, sizeof(float));
+    a->nps.Pbar    = (float *) calloc(a->nps.msize, sizeof(float));
+    a->nps.EN2y    = (float *) calloc(a->nps.msize, sizeof(float));
 
     for (i = 0; i < a->nps.msize; i++) {
-        a->nps.sigma2N[i] = 0.5;
-        a->nps.Pbar[i]    = 0.5;
+        a->nps.sigma2N[i] = 0.5f;
+        a->nps.Pbar[i]    = 0.5f;
     }
 
     /* npl */
@@ -420,42 +473,42 @@ void calc_emnr(emnr_t *a) {
     a->npl.msize    = a->msize;
     a->npl.incr     = a->incr;
     a->npl.Ysq      = a->g.lambda_y;
-    a->npl.P        = (double *) calloc(a->npl.msize, sizeof(double));
-    a->npl.Pmin     = (double *) calloc(a->npl.msize, sizeof(double));
-    a->npl.p        = (double *) calloc(a->npl.msize, sizeof(double));
-    a->npl.D        = (double *) calloc(a->npl.msize, sizeof(double));
+    a->npl.P        = (float *) calloc(a->npl.msize, sizeof(float));
+    a->npl.Pmin     = (float *) calloc(a->npl.msize, sizeof(float));
+    a->npl.p        = (float *) calloc(a->npl.msize, sizeof(float));
+    a->npl.D        = (float *) calloc(a->npl.msize, sizeof(float));
     a->npl.lambda_d = a->g.lambda_d;
 
-    tau = -256.0 / (20100.0 * log(0.7));
-    a->npl.eta = exp(-a->npl.incr / (a->npl.rate * tau));
+    tau = -256.0f / (20100.0f * logf(0.7f));
+    a->npl.eta = expf(-a->npl.incr / (a->npl.rate * tau));
 
-    tau   = -256.0 / (20100.0 * log(0.998));
-    a->npl.gamma = exp(-a->npl.incr / (a->npl.rate * tau));
+    tau   = -256.0f / (20100.0f * logf(0.998f));
+    a->npl.gamma = expf(-a->npl.incr / (a->npl.rate * tau));
 
-    tau  = -256.0 / (20100.0 * log(0.8));
-    a->npl.beta = exp(-a->npl.incr / (a->npl.rate * tau));
+    tau  = -256.0f / (20100.0f * logf(0.8f));
+    a->npl.beta = expf(-a->npl.incr / (a->npl.rate * tau));
 
-    tau     = -256.0 / (20100.0 * log(0.85));
-    a->npl.alpha_d = exp(-a->npl.incr / (a->npl.rate * tau));
+    tau     = -256.0f / (20100.0f * logf(0.85f));
+    a->npl.alpha_d = expf(-a->npl.incr / (a->npl.rate * tau));
 
-    tau     = -256.0 / (20100.0 * log(0.2));
-    a->npl.alpha_p = exp(-a->npl.incr / (a->npl.rate * tau));
+    tau     = -256.0f / (20100.0f * logf(0.2f));
+    a->npl.alpha_p = expf(-a->npl.incr / (a->npl.rate * tau));
 
-    a->npl.delta_LF = 1000.0 / (a->npl.rate / 2) * a->npl.msize;
-    a->npl.delta_MF = 3000.0 / (a->npl.rate / 2) * a->npl.msize;
-    a->npl.delta_0  = 2.0;
-    a->npl.delta_1  = 2.0;
-    a->npl.delta_2  = 5.0;
+    a->npl.delta_LF = 1000.0f / (a->npl.rate / 2) * a->npl.msize;
+    a->npl.delta_MF = 3000.0f / (a->npl.rate / 2) * a->npl.msize;
+    a->npl.delta_0  = 2.0f;
+    a->npl.delta_1  = 2.0f;
+    a->npl.delta_2  = 5.0f;
 
     /* ae */
 
     a->ae.msize      = a->msize;
     a->ae.lambda_y   = a->g.lambda_y;
 
-    a->ae.zetaThresh = 0.75;
-    a->ae.psi        = 20.0;
-    a->ae.t2         = 0.20;
-    a->ae.nmask      = (double *) calloc(a->ae.msize, sizeof(double));
+    a->ae.zetaThresh = 0.75f;
+    a->ae.psi        = 20.0f;
+    a->ae.t2         = 0.20f;
+    a->ae.nmask      = (float *) calloc(a->ae.msize, sizeof(float));
 }
 
 void decalc_emnr(emnr_t *a) {
@@ -494,15 +547,13 @@ void decalc_emnr(emnr_t *a) {
     // g
     _aligned_free(a->g.zeta_true);
     _aligned_free(a->g.zeta_hat);
-    _aligned_free(a->g.GGS);
-    _aligned_free(a->g.GG);
     _aligned_free(a->g.prev_mask);
     _aligned_free(a->g.prev_gamma);
     _aligned_free(a->g.lambda_d);
     _aligned_free(a->g.lambda_y);
     //
-    fftw_destroy_plan(a->Rrev);
-    fftw_destroy_plan(a->Rfor);
+    fftwf_destroy_plan(a->Rrev);
+    fftwf_destroy_plan(a->Rfor);
     _aligned_free(a->outaccum);
     for (i = 0; i < a->ovrlp; i++) {
         _aligned_free(a->save[i]);
@@ -520,7 +571,7 @@ void decalc_emnr(emnr_t *a) {
 
 emnr_t * emnr_create(
     int size, float *in, float *out, int fsize, int ovrlp, int rate, int wintype,
-    double gain, emnr_gain_t gain_method, emnr_npe_t npe_method, int ae_run) {
+    float gain, emnr_gain_t gain_method, emnr_npe_t npe_method, int ae_run) {
 
     emnr_t *a        = (emnr_t *) malloc(sizeof(emnr_t));
 
@@ -547,10 +598,10 @@ void emnr_flush(emnr_t *a) {
     memset(a->inaccum, 0, a->iasize * sizeof(float));
 
     for (i = 0; i < a->ovrlp; i++) {
-        memset(a->save[i], 0, a->fsize * sizeof(double));
+        memset(a->save[i], 0, a->fsize * sizeof(float));
     }
 
-    memset(a->outaccum, 0, a->oasize * sizeof(double));
+    memset(a->outaccum, 0, a->oasize * sizeof(float));
 
     a->nsamps   = 0;
     a->iainidx  = 0;
@@ -567,21 +618,21 @@ void emnr_destroy(emnr_t *a) {
 
 void LambdaD(emnr_t *a) {
     int    k;
-    double f0, f1, f2, f3;
-    double sum_prev_p;
-    double sum_lambda_y;
-    double alphaCtilda;
-    double sum_prev_sigma2N;
-    double alphaMin, SNR;
-    double beta, varHat, invQeq;
-    double invQbar;
-    double bc;
-    double QeqTilda, QeqTildaSub;
-    double noise_slope_max;
-
-    sum_prev_p       = 0.0;
-    sum_lambda_y     = 0.0;
-    sum_prev_sigma2N = 0.0;
+    float f0, f1, f2, f3;
+    float sum_prev_p;
+    float sum_lambda_y;
+    float alphaCtilda;
+    float sum_prev_sigma2N;
+    float alphaMin, SNR;
+    float beta, varHat, invQeq;
+    float invQbar;
+    float bc;
+    float QeqTilda, QeqTildaSub;
+    float noise_slope_max;
+
+    sum_prev_p       = 0.0f;
+    sum_lambda_y     = 0.0f;
+    sum_prev_sigma2N = 0.0f;
 
     for (k = 0; k < a->np.msize; k++) {
         sum_prev_p += a->np.p[k];
@@ -590,12 +641,12 @@ void LambdaD(emnr_t *a) {
     }
 
     for (k = 0; k < a->np.msize; k++) {
-        f0                   = a->np.p[k] / a->np.sigma2N[k] - 1.0;
-        a->np.alphaOptHat[k] = 1.0 / (1.0 + f0 * f0);
+        f0                   = a->np.p[k] / a->np.sigma2N[k] - 1.0f;
+        a->np.alphaOptHat[k] = 1.0f / (1.0f + f0 * f0);
     }
 
     SNR      = sum_prev_p / sum_prev_sigma2N;
-    alphaMin = fmin(a->np.alphaMin_max_value, pow(SNR, a->np.snrq));
+    alphaMin = fminf(a->np.alphaMin_max_value, powf(SNR, a->np.snrq));
 
     for (k = 0; k < a->np.msize; k++) {
         if (a->np.alphaOptHat[k] < alphaMin) {
@@ -603,9 +654,9 @@ void LambdaD(emnr_t *a) {
         }
     }
 
-    f1           = sum_prev_p / sum_lambda_y - 1.0;
-    alphaCtilda  = 1.0 / (1.0 + f1 * f1);
-    a->np.alphaC = a->np.alphaCsmooth * a->np.alphaC + (1.0 - a->np.alphaCsmooth) * fmax(alphaCtilda, a->np.alphaCmin);
+    f1           = sum_prev_p / sum_lambda_y - 1.0f;
+    alphaCtilda  = 1.0f / (1.0f + f1 * f1);
+    a->np.alphaC = a->np.alphaCsmooth * a->np.alphaC + (1.0f - a->np.alphaCsmooth) * fmaxf(alphaCtilda, a->np.alphaCmin);
     f2           = a->np.alphaMax * a->np.alphaC;
 
     for (k = 0; k < a->np.msize; k++) {
@@ -613,34 +664,34 @@ void LambdaD(emnr_t *a) {
     }
 
     for (k = 0; k < a->np.msize; k++) {
-        a->np.p[k] = a->np.alphaHat[k] * a->np.p[k] + (1.0 - a->np.alphaHat[k]) * a->np.lambda_y[k];
+        a->np.p[k] = a->np.alphaHat[k] * a->np.p[k] + (1.0f - a->np.alphaHat[k]) * a->np.lambda_y[k];
     }
 
-    invQbar = 0.0;
+    invQbar = 0.0f;
 
     for (k = 0; k < a->np.msize; k++) {
-        beta           = fmin(a->np.betamax, a->np.alphaHat[k] * a->np.alphaHat[k]);
-        a->np.pbar[k]  = beta * a->np.pbar[k] + (1.0 - beta) * a->np.p[k];
-        a->np.p2bar[k] = beta * a->np.p2bar[k] + (1.0 - beta) * a->np.p[k] * a->np.p[k];
-        varHat         = a->np.p2bar[k] - a->np.pbar[k] * a->np.pbar[k];
-        invQeq         = varHat / (2.0 * a->np.sigma2N[k] * a->np.sigma2N[k]);
+        beta           = fminf(a->np.betamax, a->np.alphaHat[k] * a->np.alphaHat[k]);
+        a->np.pbar[k]  = beta * a->np.pbar[k] + (1.0f - beta) * a->np.p[k];
+        a->np.p2bar[k] = beta * a->np.p2bar[k] + (1.0f - beta) * a->np.p[k] * a->np.p[k];
+        varHat         = fmaxf(a->np.p2bar[k] - a->np.pbar[k] * a->np.pbar[k], 0.0f);   /* float cancellation */
+        invQeq         = varHat / (2.0f * a->np.sigma2N[k] * a->np.sigma2N[k]);
 
         if (invQeq > a->np.invQeqMax) {
             invQeq = a->np.invQeqMax;
         }
 
-        a->np.Qeq[k] = 1.0 / invQeq;
+        a->np.Qeq[k] = 1.0f / invQeq;
         invQbar += invQeq;
     }
 
-    invQbar /= (double) a->np.msize;
-    bc = 1.0 + a->np.av * sqrt(invQbar);
+    invQbar /= (float) a->np.msize;
+    bc = 1.0f + a->np.av * sqrtf(invQbar);
 
     for (k = 0; k < a->np.msize; k++) {
-        QeqTilda          = (a->np.Qeq[k] - 2.0 * a->np.MofD) / (1.0 - a->np.MofD);
-        QeqTildaSub       = (a->np.Qeq[k] - 2.0 * a->np.MofV) / (1.0 - a->np.MofV);
-        a->np.bmin[k]     = 1.0 + 2.0 * (a->np.D - 1.0) / QeqTilda;
-        a->np.bmin_sub[k] = 1.0 + 2.0 * (a->np.V - 1.0) / QeqTildaSub;
+        QeqTilda          = (a->np.Qeq[k] - 2.0f * a->np.MofD) / (1.0f - a->np.MofD);
+        QeqTildaSub       = (a->np.Qeq[k] - 2.0f * a->np.MofV) / (1.0f - a->np.MofV);
+        a->np.bmin[k]     = 1.0f + 2.0f * (a->np.D - 1.0f) / QeqTilda;
+        a->np.bmin_sub[k] = 1.0f + 2.0f * (a->np.V - 1.0f) / QeqTildaSub;
     }
 
     memset(a->np.k_mod, 0, a->np.msize * sizeof(int));
@@ -667,14 +718,14 @@ void LambdaD(emnr_t *a) {
 
         for (k = 0; k < a->np.msize; k++) {
             int    ku;
-            double min;
+            float min;
 
             if (a->np.k_mod[k]) {
                 a->np.lmin_flag[k] = 0;
             }
 
             a->np.actminbuff[a->np.amb_idx][k] = a->np.actmin[k];
-            min                                = 1.0e300;
+            min                                = EMNR_HUGE;
 
             for (ku = 0; ku < a->np.U; ku++) {
                 if (a->np.actminbuff[ku][k] < min) {
@@ -693,8 +744,8 @@ void LambdaD(emnr_t *a) {
             }
 
             a->np.lmin_flag[k]  = 0;
-            a->np.actmin[k]     = 1.0e300;
-            a->np.actmin_sub[k] = 1.0e300;
+            a->np.actmin[k]     = EMNR_HUGE;
+            a->np.actmin_sub[k] = EMNR_HUGE;
         }
 
         if (++a->np.amb_idx == a->np.U) {
@@ -707,14 +758,14 @@ void LambdaD(emnr_t *a) {
             for (k = 0; k < a->np.msize; k++) {
                 if (a->np.k_mod[k]) {
                     a->np.lmin_flag[k] = 1;
-                    a->np.sigma2N[k]   = fmin(a->np.actmin_sub[k], a->np.pmin_u[k]);
+                    a->np.sigma2N[k]   = fminf(a->np.actmin_sub[k], a->np.pmin_u[k]);
                     a->np.pmin_u[k]    = a->np.sigma2N[k];
                 }
             }
         }
         ++a->np.subwc;
     }
-    memcpy(a->np.lambda_d, a->np.sigma2N, a->np.msize * sizeof(double));
+    memcpy(a->np.lambda_d, a->np.sigma2N, a->np.msize * sizeof(float));
 }
 
 void LambdaDs(emnr_t *a) {
@@ -722,28 +773,28 @@ void LambdaDs(emnr_t *a) {
 
     for (k = 0; k < a->nps.msize; k++) {
         a->nps.PH1y[k] =
-            1.0 / (1.0 + (1.0 + a->nps.epsH1) * exp(-a->nps.epsH1r * a->nps.lambda_y[k] / a->nps.sigma2N[k]));
-        a->nps.Pbar[k] = a->nps.alpha_Pbar * a->nps.Pbar[k] + (1.0 - a->nps.alpha_Pbar) * a->nps.PH1y[k];
+            1.0f / (1.0f + (1.0f + a->nps.epsH1) * expf(-a->nps.epsH1r * a->nps.lambda_y[k] / a->nps.sigma2N[k]));
+        a->nps.Pbar[k] = a->nps.alpha_Pbar * a->nps.Pbar[k] + (1.0f - a->nps.alpha_Pbar) * a->nps.PH1y[k];
 
-        if (a->nps.Pbar[k] > 0.99) {
-            a->nps.PH1y[k] = fmin(a->nps.PH1y[k], 0.99);
+        if (a->nps.Pbar[k] > 0.99f) {
+            a->nps.PH1y[k] = fminf(a->nps.PH1y[k], 0.99f);
         }
 
-        a->nps.EN2y[k]    = (1.0 - a->nps.PH1y[k]) * a->nps.lambda_y[k] + a->nps.PH1y[k] * a->nps.sigma2N[k];
-        a->nps.sigma2N[k] = a->nps.alpha_pow * a->nps.sigma2N[k] + (1.0 - a->nps.alpha_pow) * a->nps.EN2y[k];
+        a->nps.EN2y[k]    = (1.0f - a->nps.PH1y[k]) * a->nps.lambda_y[k] + a->nps.PH1y[k] * a->nps.sigma2N[k];
+        a->nps.sigma2N[k] = a->nps.alpha_pow * a->nps.sigma2N[k] + (1.0f - a->nps.alpha_pow) * a->nps.EN2y[k];
     }
 
-    memcpy(a->nps.lambda_d, a->nps.sigma2N, a->nps.msize * sizeof(double));
+    memcpy(a->nps.lambda_d, a->nps.sigma2N, a->nps.msize * sizeof(float));
 }
 
 void LambdaDl(emnr_t *a) {
-    double P_old, c, Sr, delta, I, alpha_s;
+    float P_old, c, Sr, delta, I, alpha_s;
 
-    c = (1.0 - a->npl.gamma) / (1.0 - a->npl.beta);
+    c = (1.0f - a->npl.gamma) / (1.0f - a->npl.beta);
 
     for (int k = 0; k < a->npl.msize; k++) {
         P_old       = a->npl.P[k];
-        a->npl.P[k] = a->npl.eta * P_old + (1.0 - a->npl.eta) * a->npl.Ysq[k];
+        a->npl.P[k] = a->npl.eta * P_old + (1.0f - a->npl.eta) * a->npl.Ysq[k];
 
         if (a->npl.Pmin[k] < a->npl.P[k]) {
             a->npl.Pmin[k] = a->npl.gamma * a->npl.Pmin[k] + c * (a->npl.P[k] - a->npl.beta * P_old);
@@ -762,26 +813,26 @@ void LambdaDl(emnr_t *a) {
         }
 
         if (Sr > delta) {
-            I = 1.0;
+            I = 1.0f;
         } else {
-            I = 0.0;
+            I = 0.0f;
         }
 
-        a->npl.p[k] = a->npl.alpha_p * a->npl.p[k] + (1.0 - a->npl.alpha_p) * I;
-        alpha_s     = a->npl.alpha_d + (1.0 - a->npl.alpha_d) * a->npl.p[k];
-        a->npl.D[k] = alpha_s * a->npl.D[k] + (1.0 - alpha_s) * a->npl.Ysq[k];
+        a->npl.p[k] = a->npl.alpha_p * a->npl.p[k] + (1.0f - a->npl.alpha_p) * I;
+        alpha_s     = a->npl.alpha_d + (1.0f - a->npl.alpha_d) * a->npl.p[k];
+        a->npl.D[k] = alpha_s * a->npl.D[k] + (1.0f - alpha_s) * a->npl.Ysq[k];
     }
 
-    memcpy(a->npl.lambda_d, a->npl.D, a->npl.msize * sizeof(double));
+    memcpy(a->npl.lambda_d, a->npl.D, a->npl.msize * sizeof(float));
 }
 
 void aepf(emnr_t *a) {
     int    k, m;
     int    N, n;
-    double sumPre, sumPost, zeta, zetaT;
+    float sumPre, sumPost, zeta, zetaT;
 
-    sumPre  = 0.0;
-    sumPost = 0.0;
+    sumPre  = 0.0f;
+    sumPost = 0.0f;
 
     for (k = 0; k < a->ae.msize; k++) {
         sumPre += a->ae.lambda_y[k];
@@ -791,93 +842,107 @@ void aepf(emnr_t *a) {
     zeta = sumPost / sumPre;
 
     if (zeta >= a->ae.zetaThresh) {
-        zetaT = 1.0;
+        zetaT = 1.0f;
     } else {
         zetaT = zeta;
     }
 
-    if (zetaT == 1.0) {
+    if (zetaT == 1.0f) {
         N = 1;
     } else {
-        N = 1 + 2 * (int) (0.5 + a->ae.psi * (1.0 - zetaT / a->ae.zetaThresh));
+        N = 1 + 2 * (int) (0.5f + a->ae.psi * (1.0f - zetaT / a->ae.zetaThresh));
     }
 
     n = N / 2;
 
     for (k = 0; k < n; k++) {
-        a->ae.nmask[k] = 0.0;
+        a->ae.nmask[k] = 0.0f;
 
         for (m = 0; m <= 2 * k; m++) {
             a->ae.nmask[k] += a->mask[m];
         }
 
-        a->ae.nmask[k] /= (double) (2 * k + 1);
+        a->ae.nmask[k] /= (float) (2 * k + 1);
     }
 
     for (k = n; k < (a->ae.msize - n); k++) {
-        a->ae.nmask[k] = 0.0;
+        a->ae.nmask[k] = 0.0f;
 
         for (m = k - n; m <= (k + n); m++) {
             a->ae.nmask[k] += a->mask[m];
         }
 
-        a->ae.nmask[k] /= (double) N;
+        a->ae.nmask[k] /= (float) N;
     }
 
     for (k = a->ae.msize - n; k < a->ae.msize; k++) {
-        a->ae.nmask[k] = 0.0;
+        a->ae.nmask[k] = 0.0f;
 
         for (m = (a->ae.msize - 1); m >= (-a->ae.msize + 2 * k + 1); m--) {
             a->ae.nmask[k] += a->mask[m];
         }
 
-        a->ae.nmask[k] /= (double) (2 * (a->ae.msize - k) - 1);
+        a->ae.nmask[k] /= (float) (2 * (a->ae.msize - k) - 1);
     }
 
-    memcpy(a->mask, a->ae.nmask, a->ae.msize * sizeof(double));
+    memcpy(a->mask, a->ae.nmask, a->ae.msize * sizeof(float));
 
     if (a->g.gain_method == EMNR_GAIN_TRAINED && zetaT < a->ae.t2) {
         for (k = 0; k < a->ae.msize; k++) {
-            a->mask[k] *= 0.05;
+            a->mask[k] *= 0.05f;
         }
     }
 }
 
-double getKey(double *type, double gamma, double xi) {
+float getKey(const emnr_key_t *key, float gamma, float xi) {
     int          ngamma1, ngamma2, nxi1, nxi2;
-    double       tg, tx, dg, dx;
-    const double dmin = 0.001;
-    const double dmax = 1000.0;
+    float       tg, tx, dg, dx;
+    const float dmin = 0.001f;
+    const float dmax = 1000.0f;
 
     if (gamma <= dmin) {
         ngamma1 = ngamma2 = 0;
-        tg                = 0.0;
+        tg                = 0.0f;
     } else if (gamma >= dmax) {
         ngamma1 = ngamma2 = 240;
-        tg                = 60.0;
+        tg                = 60.0f;
     } else {
-        tg      = 10.0 * log10(gamma / dmin);
-        ngamma1 = (int) (4.0 * tg);
+        tg      = 10.0f * log10f(gamma / dmin);
+        ngamma1 = (int) (4.0f * tg);
+
+        if (ngamma1 > 239) {
+            ngamma1 = 239;  /* rounding at the top edge */
+        }
+
         ngamma2 = ngamma1 + 1;
     }
 
     if (xi <= dmin) {
         nxi1 = nxi2 = 0;
-        tx          = 0.0;
+        tx          = 0.0f;
     } else if (xi >= dmax) {
         nxi1 = nxi2 = 240;
-        tx          = 60.0;
+        tx          = 60.0f;
     } else {
-        tx   = 10.0 * log10(xi / dmin);
-        nxi1 = (int) (4.0 * tx);
+        tx   = 10.0f * log10f(xi / dmin);
+        nxi1 = (int) (4.0f * tx);
+
+        if (nxi1 > 239) {
+            nxi1 = 239;
+        }
+
         nxi2 = nxi1 + 1;
     }
 
-    dg = (tg - 0.25 * ngamma1) / 0.25;
-    dx = (tx - 0.25 * nxi1) / 0.25;
+    dg = (tg - 0.25f * ngamma1) / 0.25f;
+    dx = (tx - 0.25f * nxi1) / 0.25f;
+
+    const uint16_t *t = key->data;
+
+    float v = (1.0f - dg) * (1.0f - dx) * t[241 * nxi1 + ngamma1] + (1.0f - dg) * dx * t[241 * nxi2 + ngamma1] +
+              dg * (1.0f - dx) * t[241 * nxi1 + ngamma2] + dg * dx * t[241 * nxi2 + ngamma2];
 
-    return (1.0 - dg) * (1.0 - dx) * type[241 * nxi1 + ngamma1] + (1.0 - dg) * dx * type[241 * nxi2 + ngamma1] +
-           dg * (1.0 - dx) * type[241 * nxi1 + ngamma2] + dg * dx * type[241 * nxi2 + ngamma2];
+    return v * key->scale;
 }
 
 void calc_gain(emnr_t *a) {
@@ -901,23 +966,23 @@ void calc_gain(emnr_t *a) {
 
     switch (a->g.gain_method) {
         case EMNR_GAIN_GAUSIAN_LINEAR: {
-            double gamma, eps_hat, v;
+            float gamma, eps_hat, v;
 
             for (k = 0; k < a->g.msize; k++) {
-                gamma   = fmin(a->g.lambda_y[k] / a->g.lambda_d[k], a->g.gamma_max);
+                gamma   = fminf(a->g.lambda_y[k] / a->g.lambda_d[k], a->g.gamma_max);
                 eps_hat = a->g.alpha * a->g.prev_mask[k] * a->g.prev_mask[k] * a->g.prev_gamma[k] +
-                          (1.0 - a->g.alpha) * fmax(gamma - 1.0, a->g.eps_floor);
-                eps_hat = fmax(eps_hat, a->g.xi_min);
-                v       = (eps_hat / (1.0 + eps_hat)) * gamma;
+                          (1.0f - a->g.alpha) * fmaxf(gamma - 1.0f, a->g.eps_floor);
+                eps_hat = fmaxf(eps_hat, a->g.xi_min);
+                v       = (eps_hat / (1.0f + eps_hat)) * gamma;
                 a->g.mask[k] =
-                    a->g.gf1p5 * sqrt(v) / gamma * exp(-0.5 * v) * ((1.0 + v) * bessI0(0.5 * v) + v * bessI1(0.5 * v));
+                    a->g.gf1p5 * sqrtf(v) / gamma * expf(-0.5f * v) * ((1.0f + v) * bessI0(0.5f * v) + v * bessI1(0.5f * v));
                 {
-                    double v2       = fmin(v, 700.0);
-                    double eta      = a->g.mask[k] * a->g.mask[k] * a->g.lambda_y[k] / a->g.lambda_d[k];
-                    double eps      = eta / (1.0 - a->g.q);
-                    double witchHat = (1.0 - a->g.q) / a->g.q * exp(v2) / (1.0 + eps);
+                    float v2       = fminf(v, EMNR_EXP_MAX);
+                    float eta      = a->g.mask[k] * a->g.mask[k] * a->g.lambda_y[k] / a->g.lambda_d[k];
+                    float eps      = eta / (1.0f - a->g.q);
+                    float witchHat = (1.0f - a->g.q) / a->g.q * expf(v2) / (1.0f + eps);
 
-                    a->g.mask[k] *= witchHat / (1.0 + witchHat);
+                    a->g.mask[k] *= witchHat / (1.0f + witchHat);
                 }
 
                 if (a->g.mask[k] > a->g.gmax) {
@@ -925,7 +990,7 @@ void calc_gain(emnr_t *a) {
                 }
 
                 if (a->g.mask[k] != a->g.mask[k]) {
-                    a->g.mask[k] = 0.01;
+                    a->g.mask[k] = 0.01f;
                 }
 
                 a->g.prev_gamma[k] = gamma;
@@ -935,21 +1000,21 @@ void calc_gain(emnr_t *a) {
         }
 
         case EMNR_GAIN_GAUSIAN_LOG: {
-            double gamma, eps_hat, v, ehr;
+            float gamma, eps_hat, v, ehr;
 
             for (k = 0; k < a->g.msize; k++) {
-                gamma   = fmin(a->g.lambda_y[k] / a->g.lambda_d[k], a->g.gamma_max);
+                gamma   = fminf(a->g.lambda_y[k] / a->g.lambda_d[k], a->g.gamma_max);
                 eps_hat = a->g.alpha * a->g.prev_mask[k] * a->g.prev_mask[k] * a->g.prev_gamma[k] +
-                          (1.0 - a->g.alpha) * fmax(gamma - 1.0, a->g.eps_floor);
-                ehr = eps_hat / (1.0 + eps_hat);
+                          (1.0f - a->g.alpha) * fmaxf(gamma - 1.0f, a->g.eps_floor);
+                ehr = eps_hat / (1.0f + eps_hat);
                 v   = ehr * gamma;
 
-                if ((a->g.mask[k] = ehr * exp(fmin(700.0, 0.5 * e1xb(v)))) > a->g.gmax) {
+                if ((a->g.mask[k] = ehr * expf(fminf(EMNR_EXP_MAX, 0.5f * e1xb(v)))) > a->g.gmax) {
                     a->g.mask[k] = a->g.gmax;
                 }
 
                 if (a->g.mask[k] != a->g.mask[k]) {
-                    a->g.mask[k] = 0.01;
+                    a->g.mask[k] = 0.01f;
                 }
 
                 a->g.prev_gamma[k] = gamma;
@@ -959,13 +1024,13 @@ void calc_gain(emnr_t *a) {
         }
 
         case EMNR_GAIN_GAMMA: {
-            double gamma, eps_hat, eps_p;
+            float gamma, eps_hat, eps_p;
 
             for (k = 0; k < a->g.msize; k++) {
-                gamma   = fmin(a->g.lambda_y[k] / a->g.lambda_d[k], a->g.gamma_max);
+                gamma   = fminf(a->g.lambda_y[k] / a->g.lambda_d[k], a->g.gamma_max);
                 eps_hat = a->g.alpha * a->g.prev_mask[k] * a->g.prev_mask[k] * a->g.prev_gamma[k] +
-                          (1.0 - a->g.alpha) * fmax(gamma - 1.0, a->g.eps_floor);
-                eps_p              = eps_hat / (1.0 - a->g.q);
+                          (1.0f - a->g.alpha) * fmaxf(gamma - 1.0f, a->g.eps_floor);
+                eps_p              = eps_hat / (1.0f - a->g.q);
                 a->g.mask[k]       = getKey(a->g.GG, gamma, eps_hat) * getKey(a->g.GGS, gamma, eps_p);
                 a->g.prev_gamma[k] = gamma;
                 a->g.prev_mask[k]  = a->g.mask[k];
@@ -974,22 +1039,23 @@ void calc_gain(emnr_t *a) {
         }
 
         case EMNR_GAIN_TRAINED: {
-            double gamma, xi_hat, v, zeta_hat;
+            float  gamma, xi_hat, v;
+            double zeta_hat;
 
             for (k = 0; k < a->g.msize; k++) {
-                gamma  = fmin(a->g.lambda_y[k] / a->g.lambda_d[k], a->g.gamma_max);
+                gamma  = fminf(a->g.lambda_y[k] / a->g.lambda_d[k], a->g.gamma_max);
                 xi_hat = a->g.alpha * a->g.prev_mask[k] * a->g.prev_mask[k] * a->g.prev_gamma[k] +
-                         (1.0 - a->g.alpha) * fmax(gamma - 1.0, a->g.eps_floor);
-                xi_hat = fmax(xi_hat, a->g.xi_min);
-                v      = (xi_hat / (1.0 + xi_hat)) * gamma;
+                         (1.0f - a->g.alpha) * fmaxf(gamma - 1.0f, a->g.eps_floor);
+                xi_hat = fmaxf(xi_hat, a->g.xi_min);
+                v      = (xi_hat / (1.0f + xi_hat)) * gamma;
                 a->g.mask[k] =
-                    a->g.gf1p5 * sqrt(v) / gamma * exp(-0.5 * v) * ((1.0 + v) * bessI0(0.5 * v) + v * bessI1(0.5 * v));
+                    a->g.gf1p5 * sqrtf(v) / gamma * expf(-0.5f * v) * ((1.0f + v) * bessI0(0.5f * v) + v * bessI1(0.5f * v));
                 {
-                    double v2       = fmin(v, 700.0);
-                    double eta      = a->g.mask[k] * a->g.mask[k] * a->g.lambda_y[k] / a->g.lambda_d[k];
-                    double eps      = eta / (1.0 - a->g.q);
-                    double witchHat = (1.0 - a->g.q) / a->g.q * exp(v2) / (1.0 + eps);
-                    a->g.mask[k] *= witchHat / (1.0 + witchHat);
+                    float v2       = fminf(v, EMNR_EXP_MAX);
+                    float eta      = a->g.mask[k] * a->g.mask[k] * a->g.lambda_y[k] / a->g.lambda_d[k];
+                    float eps      = eta / (1.0f - a->g.q);
+                    float witchHat = (1.0f - a->g.q) / a->g.q * expf(v2) / (1.0f + eps);
+                    a->g.mask[k] *= witchHat / (1.0f + witchHat);
                 }
 
                 if (a->g.mask[k] > a->g.gmax) {
@@ -997,36 +1063,36 @@ void calc_gain(emnr_t *a) {
                 }
 
                 if (a->g.mask[k] != a->g.mask[k]) {
-                    a->g.mask[k] = 0.01;
+                    a->g.mask[k] = 0.01f;
                 }
 
                 a->g.prev_mask[k]  = a->g.mask[k];
                 a->g.prev_gamma[k] = gamma;
 
                 {
-                    double xi_ts = a->g.mask[k] * a->g.mask[k] * gamma;
+                    float xi_ts = a->g.mask[k] * a->g.mask[k] * gamma;
 
-                    xi_ts        = fmax(xi_ts, a->g.xi_min);
+                    xi_ts        = fmaxf(xi_ts, a->g.xi_min);
 
-                    double v_ts  = (xi_ts / (1.0 + xi_ts)) * gamma;
+                    float v_ts  = (xi_ts / (1.0f + xi_ts)) * gamma;
 
-                    a->g.mask[k] = a->g.gf1p5 * sqrt(v_ts) / gamma * exp(-0.5 * v_ts) *
-                                   ((1.0 + v_ts) * bessI0(0.5 * v_ts) + v_ts * bessI1(0.5 * v_ts));
+                    a->g.mask[k] = a->g.gf1p5 * sqrtf(v_ts) / gamma * expf(-0.5f * v_ts) *
+                                   ((1.0f + v_ts) * bessI0(0.5f * v_ts) + v_ts * bessI1(0.5f * v_ts));
 
-                    double v2       = fmin(v, 700.0);
-                    double eta      = a->g.mask[k] * a->g.mask[k] * a->g.lambda_y[k] / a->g.lambda_d[k];
-                    double eps      = eta / (1.0 - a->g.q);
-                    double witchHat = (1.0 - a->g.q) / a->g.q * exp(v2) / (1.0 + eps);
+                    float v2       = fminf(v, EMNR_EXP_MAX);
+                    float eta      = a->g.mask[k] * a->g.mask[k] * a->g.lambda_y[k] / a->g.lambda_d[k];
+                    float eps      = eta / (1.0f - a->g.q);
+                    float witchHat = (1.0f - a->g.q) / a->g.q * expf(v2) / (1.0f + eps);
 
-                    a->g.mask[k] *= witchHat / (1.0 + witchHat);
+                    a->g.mask[k] *= witchHat / (1.0f + witchHat);
                     xi_hat = xi_ts;
                 }
 
                 if (get_zeta(gamma, xi_hat, &zeta_hat) >= 0) {
                     if (zeta_hat > a->g.zeta_thresh) {
-                        a->g.mask[k] = 1.0;
+                        a->g.mask[k] = 1.0f;
                     } else {
-                        a->g.mask[k] = 0.0;
+                        a->g.mask[k] = 0.0f;
                     }
                 }
             }
@@ -1041,7 +1107,7 @@ void calc_gain(emnr_t *a) {
 
 void emnr_apply(emnr_t *a) {
     int    i, j, k, sbuff, sbegin;
-    double g1;
+    float  g1;
 
     for (i = 0; i < a->bsize; i++) {
         a->inaccum[a->iainidx] = a->in[i];
@@ -1057,7 +1123,7 @@ void emnr_apply(emnr_t *a) {
 
         a->iaoutidx = (a->iaoutidx + a->incr) % a->iasize;
         a->nsamps -= a->incr;
-        fftw_execute(a->Rfor);
+        fftwf_execute(a->Rfor);
         calc_gain(a);
 
         for (i = 0; i < a->msize; i++) {
@@ -1066,7 +1132,7 @@ void emnr_apply(emnr_t *a) {
             a->revfftin[2 * i + 1] = g1 * a->forfftout[2 * i + 1];
         }
 
-        fftw_execute(a->Rrev);
+        fftwf_execute(a->Rrev);
 
         for (i = 0; i < a->fsize; i++) {
             a->save[a->saveidx][i] = a->window[i] * a->revfftout[i];
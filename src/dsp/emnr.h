@@ -12,6 +12,7 @@
 #pragma once
 
 #include <fftw3.h>
+#include "calculus.h"
 
 typedef enum {
     EMNR_GAIN_GAUSIAN_LINEAR = 0,
@@ -33,22 +34,22 @@ typedef struct {
     int       fsize;
     int       ovrlp;
     int       incr;
-    double   *window;
+    float    *window;
     int       iasize;
     float    *inaccum;
-    double   *forfftin;
-    double   *forfftout;
+    float    *forfftin;
+    float    *forfftout;
     int       msize;
-    double   *mask;
-    double   *revfftin;
-    double   *revfftout;
-    double  **save;
+    float    *mask;
+    float    *revfftin;
+    float    *revfftout;
+    float   **save;
     int       oasize;
-    double   *outaccum;
-    double    rate;
+    float    *outaccum;
+    float     rate;
     int       wintype;
-    double    ogain;
-    double    gain;
+    float     ogain;
+    float     gain;
     int       nsamps;
     int       iainidx;
     int       iaoutidx;
@@ -56,126 +57,126 @@ typedef struct {
     int       oainidx;
     int       oaoutidx;
     int       saveidx;
-    fftw_plan Rfor;
-    fftw_plan Rrev;
+    fftwf_plan Rfor;
+    fftwf_plan Rrev;
 
     struct {
         emnr_gain_t gain_method;
         emnr_npe_t  npe_method;
         int         ae_run;
-        double      msize;
-        double     *mask;
-        double     *y;
-        double     *lambda_y;
-        double     *lambda_d;
-        double     *prev_mask;
-        double     *prev_gamma;
-        double      gf1p5;
-        double      alpha;
-        double      eps_floor;
-        double      gamma_max;
-        double      xi_min;
-        double      q;
-        double      gmax;
-        double     *GG;
-        double     *GGS;
-        double      zeta_thresh;
+        int         msize;
+        float      *mask;
+        float      *y;
+        float      *lambda_y;
+        float      *lambda_d;
+        float      *prev_mask;
+        float      *prev_gamma;
+        float       gf1p5;
+        float       alpha;
+        float       eps_floor;
+        float       gamma_max;
+        float       xi_min;
+        float       q;
+        float       gmax;
+        const emnr_key_t *GG;
+        const emnr_key_t *GGS;
+        float       zeta_thresh;
     } g;
 
     struct {
         int      incr;
-        double   rate;
+        float    rate;
         int      msize;
-        double  *lambda_y;
-        double  *lambda_d;
-        double  *p;
-        double  *alphaOptHat;
-        double   alphaC;
-        double   alphaCsmooth;
-        double   alphaCmin;
-        double  *alphaHat;
-        double   alphaMax;
-        double  *sigma2N;
-        double   alphaMin_max_value;
-        double   snrq;
-        double   betamax;
-        double  *pbar;
-        double  *p2bar;
-        double   invQeqMax;
-        double   av;
-        double  *Qeq;
+        float   *lambda_y;
+        float   *lambda_d;
+        float   *p;
+        float   *alphaOptHat;
+        float    alphaC;
+        float    alphaCsmooth;
+        float    alphaCmin;
+        float   *alphaHat;
+        float    alphaMax;
+        float   *sigma2N;
+        float    alphaMin_max_value;
+        float    snrq;
+        float    betamax;
+        float   *pbar;
+        float   *p2bar;
+        float    invQeqMax;
+        float    av;
+        float   *Qeq;
         int      U;
-        double   Dtime;
+        float    Dtime;
         int      V;
         int      D;
-        double   MofD;
-        double   MofV;
-        double  *bmin;
-        double  *bmin_sub;
+        float    MofD;
+        float    MofV;
+        float   *bmin;
+        float   *bmin_sub;
         int     *k_mod;
-        double  *actmin;
-        double  *actmin_sub;
+        float   *actmin;
+        float   *actmin_sub;
         int      subwc;
         int     *lmin_flag;
-        double  *pmin_u;
-        double   invQbar_points[4];
-        double   nsmax[4];
-        double **actminbuff;
+        float   *pmin_u;
+        float    invQbar_points[4];
+        float    nsmax[4];
+        float  **actminbuff;
         int      amb_idx;
     } np;
 
     struct {
         int     incr;
-        double  rate;
+        float   rate;
         int     msize;
-        double *lambda_y;
-        double *lambda_d;
-
-        double  alpha_pow;
-        double  alpha_Pbar;
-        double  epsH1;
-        double  epsH1r;
-
-        double *sigma2N;
-        double *PH1y;
-        double *Pbar;
-        double *EN2y;
+        float  *lambda_y;
+        float  *lambda_d;
+
+        float   alpha_pow;
+        float   alpha_Pbar;
+        float   epsH1;
+        float   epsH1r;
+
+        float  *sigma2N;
+        float  *PH1y;
+        float  *Pbar;
+        float  *EN2y;
     } nps;
 
     struct {
-        double  rate;
+        float   rate;
         int     msize;
         int     incr;
-        double *Ysq;
-        double *P;
-        double *Pmin;
-        double *p;
-        double *D;
-        double *lambda_d;
-
-        double  eta;
-        double  gamma;
-        double  beta;
-        double  delta_LF;
-        double  delta_MF;
-        double  delta_0;
-        double  delta_1;
-        double  delta_2;
-        double  alpha_d;
-        double  alpha_p;
+        float  *Ysq;
+        float  *P;
+        float  *Pmin;
+        float  *p;
+        float  *D;
+        float  *lambda_d;
+
+        float   eta;
+        float   gamma;
+        float   beta;
+        float   delta_LF;
+        float   delta_MF;
+        float   delta_0;
+        float   delta_1;
+        float   delta_2;
+        float   alpha_d;
+        float   alpha_p;
     } npl;
 
     struct {
         int     msize;
-        double *lambda_y;
-        double  zetaThresh;
-        double  psi;
-        double *nmask;
-        double  t2;
+        float  *lambda_y;
+        float   zetaThresh;
+        float   psi;
+        float  *nmask;
+        float   t2;
     } ae;
 } emnr_t;
 
-emnr_t *emnr_create(int size, float *in, float *out, int fsize, int ovrlp, int rate, int wintype, double gain,
+emnr_t *emnr_create(int size, float *in, float *out, int fsize, int ovrlp, int rate, int wintype, float gain,
                     emnr_gain_t gain_method, emnr_npe_t npe_method, int ae_run);
 
 void    emnr_apply(emnr_t *a);
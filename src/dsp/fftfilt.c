@@ -0,0 +1,148 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "fftfilt.h"
+
+fftfilt_t * fftfilt_create(const float *taps, size_t taps_len, size_t block) {
+    fftfilt_t *f = (fftfilt_t *) malloc(sizeof(fftfilt_t));
+
+    f->block = block;
+    f->fft_size = block * 2;
+    f->parts = (taps_len + block - 1) / block;
+
+    f->fft_in = (float complex *) calloc(f->fft_size, sizeof(float complex));
+    f->fft_out = (float complex *) calloc(f->fft_size, sizeof(float complex));
+    f->acc = (float complex *) calloc(f->fft_size, sizeof(float complex));
+    f->ifft_out = (float complex *) calloc(f->fft_size, sizeof(float complex));
+
+    f->fwd = fft_create_plan(f->fft_size, f->fft_in, f->fft_out, LIQUID_FFT_FORWARD, 0);
+    f->rev = fft_create_plan(f->fft_size, f->acc, f->ifft_out, LIQUID_FFT_BACKWARD, 0);
+
+    f->taps_fft = (float complex *) malloc(f->parts * f->fft_size * sizeof(float complex));
+    f->fdl = (float complex *) calloc(f->parts * f->fft_size, sizeof(float complex));
+    f->fdl_pos = 0;
+
+    f->in_buf = (float *) calloc(block, sizeof(float));
+    f->out_buf = (float *) calloc(block, sizeof(float));
+    f->pos = 0;
+
+    /* Spectrum of each partition, zero padded to the FFT size. 1/N of the inverse FFT is here too */
+
+    float scale = 1.0f / f->fft_size;
+
+    for (size_t p = 0; p < f->parts; p++) {
+        memset(f->fft_in, 0, f->fft_size * sizeof(float complex));
+
+        for (size_t i = 0; i < block && p * block + i < taps_len; i++) {
+            f->fft_in[i] = taps[p * block + i];
+        }
+
+        fft_execute(f->fwd);
+
+        float complex *h = &f->taps_fft[p * f->fft_size];
+
+        for (size_t i = 0; i < f->fft_size; i++) {
+            h[i] = f->fft_out[i] * scale;
+        }
+    }
+
+    memset(f->fft_in, 0, f->fft_size * sizeof(float complex));
+
+    return f;
+}
+
+void fftfilt_destroy(fftfilt_t *f) {
+    fft_destroy_plan(f->fwd);
+    fft_destroy_plan(f->rev);
+
+    free(f->fft_in);
+    free(f->fft_out);
+    free(f->acc);
+    free(f->ifft_out);
+    free(f->taps_fft);
+    free(f->fdl);
+    free(f->in_buf);
+    free(f->out_buf);
+    free(f);
+}
+
+void fftfilt_reset(fftfilt_t *f) {
+    memset(f->fft_in, 0, f->fft_size * sizeof(float complex));
+    memset(f->fdl, 0, f->parts * f->fft_size * sizeof(float complex));
+    memset(f->in_buf, 0, f->block * sizeof(float));
+    memset(f->out_buf, 0, f->block * sizeof(float));
+
+    f->fdl_pos = 0;
+    f->pos = 0;
+}
+
+static void process(fftfilt_t *f) {
+    size_t  block = f->block;
+    size_t  size = f->fft_size;
+
+    /* Previous block and the new one */
+
+    memmove(f->fft_in, f->fft_in + block, block * sizeof(float complex));
+
+    for (size_t i = 0; i < block; i++) {
+        f->fft_in[block + i] = f->in_buf[i];
+    }
+
+    fft_execute(f->fwd);
+
+    /* Frequency delay line, the newest spectrum goes to fdl_pos */
+
+    f->fdl_pos = (f->fdl_pos + f->parts - 1) % f->parts;
+    memcpy(&f->fdl[f->fdl_pos * size], f->fft_out, size * sizeof(float complex));
+
+    memset(f->acc, 0, size * sizeof(float complex));
+
+    for (size_t p = 0; p < f->parts; p++) {
+        const float complex *x = &f->fdl[((f->fdl_pos + p) % f->parts) * size];
+        const float complex *h = &f->taps_fft[p * size];
+
+        for (size_t i = 0; i < size; i++) {
+            f->acc[i] += x[i] * h[i];
+        }
+    }
+
+    fft_execute(f->rev);
+
+    /* Last half is the valid part of the circular convolution */
+
+    for (size_t i = 0; i < block; i++) {
+        f->out_buf[i] = crealf(f->ifft_out[block + i]);
+    }
+}
+
+/* Any n, in and out may be the same buffer */
+
+void fftfilt_execute_block(fftfilt_t *f, const float *in, float *out, size_t n) {
+    while (n) {
+        size_t part = f->block - f->pos;
+
+        if (part > n) {
+            part = n;
+        }
+
+        memcpy(f->in_buf + f->pos, in, part * sizeof(float));
+        memcpy(out, f->out_buf + f->pos, part * sizeof(float));
+
+        f->pos += part;
+        in += part;
+        out += part;
+        n -= part;
+
+        if (f->pos == f->block) {
+            process(f);
+            f->pos = 0;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <complex.h>
+#include <liquid/liquid.h>
+
+/*
+ * Real FIR filter by uniformly partitioned overlap-save. The taps are split
+ * in partitions of one block, so the cost per sample grows with the number
+ * of partitions only, not with taps_len * block. Adds one block of latency
+ */
+
+typedef struct {
+    size_t          block;
+    size_t          fft_size;
+    size_t          parts;
+
+    float complex   *fft_in;
+    float complex   *fft_out;
+    float complex   *acc;
+    float complex   *ifft_out;
+    fftplan         fwd;
+    fftplan         rev;
+
+    float complex   *taps_fft;
+    float complex   *fdl;
+    size_t          fdl_pos;
+
+    float           *in_buf;
+    float           *out_buf;
+    size_t          pos;
+} fftfilt_t;
+
+fftfilt_t * fftfilt_create(const float *taps, size_t taps_len, size_t block);
+void fftfilt_destroy(fftfilt_t *f);
+void fftfilt_reset(fftfilt_t *f);
+void fftfilt_execute_block(fftfilt_t *f, const float *in, float *out, size_t n);
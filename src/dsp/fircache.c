@@ -0,0 +1,81 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "fircache.h"
+#include "firdes.h"
+
+#define FIRCACHE_SIZE   16
+
+typedef struct {
+    float       sample_freq;
+    float       low_freq;
+    float       high_freq;
+    float       transition;
+    float       *taps;
+    size_t      taps_len;
+    uint32_t    used;
+} fircache_item_t;
+
+static fircache_item_t  cache[FIRCACHE_SIZE];
+static uint32_t         used = 0;
+
+const float * fircache_band_pass(float sample_freq, float low_freq, float high_freq, float transition, size_t *taps_len) {
+    fircache_item_t *item = &cache[0];
+
+    used++;
+
+    for (int i = 0; i < FIRCACHE_SIZE; i++) {
+        fircache_item_t *x = &cache[i];
+
+        if (x->taps &&
+            x->sample_freq == sample_freq && x->low_freq == low_freq &&
+            x->high_freq == high_freq && x->transition == transition)
+        {
+            x->used = used;
+            *taps_len = x->taps_len;
+
+            return x->taps;
+        }
+
+        /* Empty slot or the least recently used one */
+
+        if (item->taps && (!x->taps || x->used < item->used)) {
+            item = x;
+        }
+    }
+
+    size_t len = firdes_compute_taps_len(sample_freq, transition, 40.0f);
+
+    if (item->taps_len != len) {
+        item->taps = realloc(item->taps, len * sizeof(float));
+        item->taps_len = len;
+    }
+
+    firdes_band_pass(1.0f, sample_freq, low_freq, high_freq, item->taps, len);
+
+    item->sample_freq = sample_freq;
+    item->low_freq = low_freq;
+    item->high_freq = high_freq;
+    item->transition = transition;
+    item->used = used;
+
+    *taps_len = len;
+
+    return item->taps;
+}
+
+void fircache_clear() {
+    for (int i = 0; i < FIRCACHE_SIZE; i++) {
+        free(cache[i].taps);
+
+        cache[i].taps = NULL;
+        cache[i].taps_len = 0;
+    }
+}
@@ -0,0 +1,19 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+/*
+ * LRU cache of designed band-pass taps. Not thread safe, the returned taps
+ * stay valid until the next call
+ */
+
+const float * fircache_band_pass(float sample_freq, float low_freq, float high_freq, float transition, size_t *taps_len);
+void fircache_clear();
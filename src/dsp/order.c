@@ -0,0 +1,117 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "order.h"
+
+static inline void swap(float *a, float *b) {
+    float t = *a;
+
+    *a = *b;
+    *b = t;
+}
+
+float order_select(float *data, size_t n, size_t k) {
+    size_t  left = 0;
+    size_t  right = n - 1;
+
+    while (right > left) {
+        /* Median of three as the pivot, it ends up in data[right - 1] */
+
+        size_t mid = left + (right - left) / 2;
+
+        if (data[mid] < data[left]) swap(&data[mid], &data[left]);
+        if (data[right] < data[left]) swap(&data[right], &data[left]);
+        if (data[right] < data[mid]) swap(&data[right], &data[mid]);
+
+        if (right - left < 3) {
+            break;
+        }
+
+        swap(&data[mid], &data[right - 1]);
+
+        float   pivot = data[right - 1];
+        size_t  i = left;
+        size_t  j = right - 1;
+
+        while (true) {
+            while (data[++i] < pivot);
+            while (pivot < data[--j]);
+
+            if (i >= j) {
+                break;
+            }
+
+            swap(&data[i], &data[j]);
+        }
+
+        swap(&data[i], &data[right - 1]);
+
+        if (k < i) {
+            right = i - 1;
+        } else if (k > i) {
+            left = i + 1;
+        } else {
+            break;
+        }
+    }
+
+    return data[k];
+}
+
+float order_percentile(const float *data, size_t n, float percent, float *work) {
+    if (n == 0) {
+        return 0.0f;
+    }
+
+    size_t k = percent * (n - 1) / 100.0f + 0.5f;
+
+    if (k >= n) {
+        k = n - 1;
+    }
+
+    memcpy(work, data, n * sizeof(float));
+
+    return order_select(work, n, k);
+}
+
+void order_tails(const float *data, size_t n, size_t low_k, size_t high_k, float *low, float *high, float *work) {
+    if (low_k > n || high_k > n - low_k) {
+        low_k = n / 2;
+        high_k = n - low_k;
+    }
+
+    memcpy(work, data, n * sizeof(float));
+
+    float sum = 0.0f;
+
+    if (high_k) {
+        order_select(work, n, n - high_k);
+
+        for (size_t i = n - high_k; i < n; i++) {
+            sum += work[i];
+        }
+
+        *high = sum / high_k;
+    }
+
+    sum = 0.0f;
+
+    if (low_k) {
+        /* The smallest ones are all left of the high tail now */
+
+        order_select(work, n - high_k, low_k - 1);
+
+        for (size_t i = 0; i < low_k; i++) {
+            sum += work[i];
+        }
+
+        *low = sum / low_k;
+    }
+}
@@ -0,0 +1,26 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+/*
+ * Order statistics in linear time by quickselect. The data is left as is,
+ * selection runs on work, which must hold n floats
+ */
+
+float order_percentile(const float *data, size_t n, float percent, float *work);
+
+/* Mean of the low_k smallest and of the high_k largest values */
+
+void order_tails(const float *data, size_t n, size_t low_k, size_t high_k, float *low, float *high, float *work);
+
+/* In place: afterwards data[k] is the k-th smallest, smaller ones are before it, larger ones after */
+
+float order_select(float *data, size_t n, size_t k);
@@ -0,0 +1,276 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/time.h>
+
+#include "lvgl/lvgl.h"
+#include "fft_capture.h"
+#include "fft_file.h"
+#include "ring.h"
+#include "util.h"
+#include "msg.h"
+#include "dsp.h"
+#include "recorder.h"
+#include "bands/bands.h"
+#include "settings/options.h"
+#include "dsp/db.h"
+#include "fpga/mb_data.h"
+#include "fpga/control.h"
+
+#define RING_SIZE   (64 * 1024)
+#define WRITER_MS   250
+#define DEFAULT_FPS 4               /* 2048 bytes a frame, about 30 MB an hour */
+
+#define DB_MIN      (-60.0f)
+#define DB_STEP_8   0.75f
+#define DB_STEP_16  (1.0f / 128.0f)
+
+static atomic_bool          on = false;
+static FILE                 *file = NULL;
+static pthread_mutex_t      file_mux;
+
+static ring_t               *ring;
+static uint64_t             start_time;
+static atomic_uint_fast64_t frames;
+static atomic_uint_fast64_t dropped;
+
+/* MB thread only */
+
+static float                sum[FFT_SAMPLES];
+static float                db[FFT_SAMPLES];
+static uint16_t             count = 0;
+static uint64_t             next_time;
+static uint64_t             period;
+static uint8_t              bits;
+static float                db_step;
+
+static uint8_t              frame_buf[sizeof(fft_frame_t) + FFT_SAMPLES * sizeof(uint16_t)];
+
+static bool create_file() {
+    char        filename[64];
+    time_t      now = time(NULL);
+    struct tm   *t = localtime(&now);
+
+    snprintf(filename, sizeof(filename),
+        "%s/FFT_%04i%02i%02i_%02i%02i%02i.fft",
+        recorder_path, t->tm_year + 1900, t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec
+    );
+
+    file = fopen(filename, "wb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    uint8_t fps = options->iq.fft_fps ? options->iq.fft_fps : DEFAULT_FPS;
+
+    bits = options->iq.fft_wide ? 16 : 8;
+    db_step = options->iq.fft_wide ? DB_STEP_16 : DB_STEP_8;
+    period = 1000000 / fps;
+
+    fft_file_header_t   header;
+    struct timeval      tv;
+
+    gettimeofday(&tv, NULL);
+    memset(&header, 0, sizeof(header));
+
+    header.magic = FFT_FILE_MAGIC;
+    header.version = FFT_FILE_VERSION;
+    header.header_size = sizeof(header);
+    header.bins = FFT_SAMPLES;
+    header.bits = bits;
+    header.fps = fps;
+    header.db_min = DB_MIN;
+    header.db_step = db_step;
+    header.start = (int64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+
+    if (band_settings && band_settings->label) {
+        strncpy(header.band, band_settings->label, sizeof(header.band) - 1);
+    }
+
+    fwrite(&header, sizeof(header), 1, file);
+
+    return true;
+}
+
+static void write_ring() {
+    void    *data;
+    size_t  len;
+
+    while ((len = ring_read_ptr(ring, &data)) > 0) {
+        fwrite(data, 1, len, file);
+        ring_release(ring, len);
+    }
+}
+
+static void * writer_thread(void *arg) {
+    while (true) {
+        usleep(WRITER_MS * 1000);
+
+        pthread_mutex_lock(&file_mux);
+
+        if (file) {
+            write_ring();
+        }
+
+        pthread_mutex_unlock(&file_mux);
+    }
+}
+
+void fft_capture_init() {
+    pthread_mutex_init(&file_mux, NULL);
+
+    ring = ring_create(RING_SIZE);
+    atomic_init(&frames, 0);
+    atomic_init(&dropped, 0);
+
+    if (!ring) {
+        LV_LOG_ERROR("Unable to allocate FFT capture ring");
+        return;
+    }
+
+    pthread_t thread;
+
+    pthread_create(&thread, NULL, writer_thread, NULL);
+    pthread_detach(thread);
+}
+
+void fft_capture_set_on(bool x) {
+    if (x) {
+        pthread_mutex_lock(&file_mux);
+
+        if (!ring || !create_file()) {
+            pthread_mutex_unlock(&file_mux);
+            msg_set_text_fmt("Problem with create file");
+            return;
+        }
+
+        ring_clear(ring);
+        start_time = get_time_us();
+        next_time = start_time + period;
+        count = 0;
+        memset(sum, 0, sizeof(sum));
+        atomic_store(&frames, 0);
+        atomic_store(&dropped, 0);
+
+        pthread_mutex_unlock(&file_mux);
+
+        atomic_store(&on, true);
+        msg_set_text_fmt("FFT capture is on");
+    } else {
+        atomic_store(&on, false);
+        msg_set_text_fmt("FFT capture is off");
+
+        pthread_mutex_lock(&file_mux);
+
+        if (file) {
+            write_ring();
+            fclose(file);
+            file = NULL;
+        }
+
+        pthread_mutex_unlock(&file_mux);
+
+        fft_capture_stats_t stats;
+
+        fft_capture_get_stats(&stats);
+
+        if (stats.dropped) {
+            LV_LOG_WARN("FFT dropped %llu of %llu frames",
+                (unsigned long long) stats.dropped, (unsigned long long) stats.frames);
+        }
+    }
+}
+
+bool fft_capture_is_on() {
+    return atomic_load(&on);
+}
+
+static void put_frame(uint64_t now) {
+    fft_frame_t *frame = (fft_frame_t *) frame_buf;
+    size_t      size = sizeof(fft_frame_t) + FFT_SAMPLES * bits / 8;
+
+    frame->time = now - start_time;
+    frame->freq = control_get_fft_freq();
+    frame->spectrum_factor = dsp_get_spectrum_factor();
+    frame->averaged = count;
+    frame->reserved = 0;
+
+    db_from_power(sum, db, FFT_SAMPLES, -10.0f * log10f(count), DB_MIN);
+
+    uint8_t     *q8 = frame_buf + sizeof(fft_frame_t);
+    uint16_t    *q16 = (uint16_t *) q8;
+    float       max = bits == 8 ? 255.0f : 65535.0f;
+
+    for (size_t i = 0; i < FFT_SAMPLES; i++) {
+        float q = (db[i] - DB_MIN) / db_step + 0.5f;
+
+        if (q < 0.0f) {
+            q = 0.0f;
+        } else if (q > max) {
+            q = max;
+        }
+
+        if (bits == 8) {
+            q8[i] = q;
+        } else {
+            q16[i] = q;
+        }
+    }
+
+    if (ring_write(ring, frame_buf, size)) {
+        atomic_fetch_add(&frames, 1);
+    } else {
+        atomic_fetch_add(&dropped, 1);
+    }
+}
+
+/* From the MB thread. MicroBlaze frames are averaged down to the capture rate */
+
+void fft_capture_put(const float *data) {
+    if (!atomic_load(&on)) {
+        return;
+    }
+
+    for (size_t i = 0; i < FFT_SAMPLES; i++) {
+        sum[i] += data[i];
+    }
+
+    count++;
+
+    uint64_t now = get_time_us();
+
+    if (now < next_time) {
+        return;
+    }
+
+    put_frame(now);
+
+    memset(sum, 0, sizeof(sum));
+    count = 0;
+    next_time += period;
+
+    if (next_time < now) {
+        next_time = now + period;
+    }
+}
+
+void fft_capture_get_stats(fft_capture_stats_t *stats) {
+    stats->frames = atomic_load(&frames);
+    stats->dropped = atomic_load(&dropped);
+    stats->high_water = ring ? ring_high_water(ring) : 0;
+    stats->capacity = ring ? ring->size : 0;
+}
@@ -0,0 +1,27 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+    uint64_t    frames;
+    uint64_t    dropped;        /* Frames lost on a full ring */
+    size_t      high_water;     /* Bytes */
+    size_t      capacity;       /* Bytes */
+} fft_capture_stats_t;
+
+void fft_capture_init();
+
+void fft_capture_set_on(bool on);
+bool fft_capture_is_on();
+void fft_capture_put(const float *data);
+void fft_capture_get_stats(fft_capture_stats_t *stats);
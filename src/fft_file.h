@@ -0,0 +1,42 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Panadapter capture: one header, then frames of an fft_frame_t followed by
+ * bins quantized values, uint8 or uint16 as bits says. A value q stands for
+ * db_min + q * db_step dB of the MicroBlaze power, bins in its own order
+ */
+
+#define FFT_FILE_MAGIC      0x54465342  /* "BSFT" */
+#define FFT_FILE_VERSION    1
+
+typedef struct {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    header_size;
+    uint16_t    bins;
+    uint8_t     bits;
+    uint8_t     fps;            /* Nominal, the frame times are exact */
+    float       db_min;
+    float       db_step;
+    uint32_t    reserved;
+    int64_t     start;          /* Unix time, us */
+    char        band[16];
+} fft_file_header_t;
+
+typedef struct {
+    uint64_t    time;           /* Since the start, us */
+    uint64_t    freq;           /* FFT center frequency, Hz */
+    uint16_t    spectrum_factor;
+    uint16_t    averaged;       /* MicroBlaze frames in this one */
+    uint32_t    reserved;
+} fft_frame_t;
@@ -0,0 +1,170 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "lvgl/lvgl.h"
+#include "fft_play.h"
+#include "fft_file.h"
+#include "util.h"
+#include "msg.h"
+#include "settings/options.h"
+#include "fpga/mb_data.h"
+
+static atomic_bool          on = false;
+static FILE                 *file = NULL;
+static pthread_mutex_t      file_mux;
+
+static fft_file_header_t    header;
+static long                 data_start;
+static uint64_t             wall_start;
+static uint64_t             file_offset;    /* Frame time shift after a loop */
+static uint64_t             last_time;
+
+static uint16_t             quant[FFT_SAMPLES];
+static float                frame[FFT_SAMPLES];
+static float                lut[256];       /* 8 bit power, the common case */
+
+void fft_play_init() {
+    pthread_mutex_init(&file_mux, NULL);
+}
+
+static void close_file() {
+    if (file) {
+        fclose(file);
+        file = NULL;
+    }
+}
+
+bool fft_play_start(const char *path) {
+    fft_play_stop();
+
+    pthread_mutex_lock(&file_mux);
+
+    file = fopen(path, "rb");
+
+    if (file) {
+        if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != FFT_FILE_MAGIC
+            || header.bins != FFT_SAMPLES || (header.bits != 8 && header.bits != 16))
+        {
+            LV_LOG_ERROR("%s is not an FFT capture", path);
+            close_file();
+        } else {
+            fseek(file, header.header_size, SEEK_SET);
+            data_start = ftell(file);
+            wall_start = 0;
+            file_offset = 0;
+            last_time = 0;
+
+            for (int i = 0; i < 256; i++) {
+                lut[i] = expf((header.db_min + i * header.db_step) * (logf(10.0f) / 10.0f));
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&file_mux);
+
+    if (!file) {
+        msg_set_text_fmt("Problem with FFT file");
+        return false;
+    }
+
+    atomic_store(&on, true);
+
+    return true;
+}
+
+void fft_play_stop() {
+    atomic_store(&on, false);
+
+    pthread_mutex_lock(&file_mux);
+    close_file();
+    pthread_mutex_unlock(&file_mux);
+}
+
+bool fft_play_is_on() {
+    return atomic_load(&on);
+}
+
+static bool read_frame(fft_frame_t *f) {
+    if (fread(f, sizeof(*f), 1, file) != 1) {
+        return false;
+    }
+
+    return fread(quant, header.bits / 8, FFT_SAMPLES, file) == FFT_SAMPLES;
+}
+
+const float * fft_play_wait() {
+    fft_frame_t f;
+    bool        ok = false;
+
+    pthread_mutex_lock(&file_mux);
+
+    if (file) {
+        ok = read_frame(&f);
+
+        if (!ok && options->iq.loop && fseek(file, data_start, SEEK_SET) == 0) {
+            file_offset = last_time + 1000000 / (header.fps ? header.fps : 1);
+            ok = read_frame(&f);
+        }
+
+        if (ok) {
+            f.time += file_offset;
+            last_time = f.time;
+
+            if (header.bits == 8) {
+                const uint8_t *q = (const uint8_t *) quant;
+
+                for (size_t i = 0; i < FFT_SAMPLES; i++) {
+                    frame[i] = lut[q[i]];
+                }
+            } else {
+                float scale = header.db_step * (logf(10.0f) / 10.0f);
+                float base = header.db_min * (logf(10.0f) / 10.0f);
+
+                for (size_t i = 0; i < FFT_SAMPLES; i++) {
+                    frame[i] = expf(base + quant[i] * scale);
+                }
+            }
+        } else {
+            close_file();
+            atomic_store(&on, false);
+            msg_set_text_fmt("FFT playback is over");
+        }
+    }
+
+    pthread_mutex_unlock(&file_mux);
+
+    if (!ok) {
+        return NULL;
+    }
+
+    /* Frame times, speed times faster */
+
+    if (!options->iq.fast) {
+        uint8_t     speed = options->iq.speed ? options->iq.speed : 1;
+        uint64_t    now = get_time_us();
+
+        if (wall_start == 0) {
+            wall_start = now - f.time / speed;
+        }
+
+        uint64_t at = wall_start + f.time / speed;
+
+        if (at > now) {
+            usleep(at - now);
+        }
+    }
+
+    return frame;
+}
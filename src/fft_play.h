@@ -0,0 +1,20 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+void fft_play_init();
+
+bool fft_play_start(const char *path);
+void fft_play_stop();
+bool fft_play_is_on();
+
+/* From the MB thread instead of the front-end: the next frame at its time, NULL at the end */
+const float * fft_play_wait();
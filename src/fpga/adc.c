@@ -11,46 +11,200 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <pthread.h>
+#include <semaphore.h>
 #include <string.h>
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <poll.h>
+#include <time.h>
 
 #include "lvgl/lvgl.h"
 #include "src/dsp.h"
+#include "src/ring.h"
+#include "src/iq_capture.h"
+#include "src/iq_play.h"
+#include "src/util.h"
+#include "src/settings/options.h"
 #include "adc.h"
 #include "control.h"
+#include "backend.h"
 
-static int              fd;
-static float complex    samples[ADC_SAMPLES];
+#define ADC_BATCH       (ADC_SAMPLES * 8)   /* Complex samples per read() */
+#define ADC_RING_SIZE   (128 * 1024)
+#define ADC_STALL_MS    50                  /* No data for so long is an underrun */
+#define ADC_STATS_MS    5000
+
+typedef struct {
+    uint32_t        samples;
+    float complex   data[ADC_SAMPLES];
+} adc_block_t;
+
+static float complex    batch[ADC_BATCH];
+static adc_block_t      in_block;
+static adc_block_t      out_block;
+
+static ring_t           *ring;
+static size_t           ring_blocks;
+static sem_t            ring_sem;
+
+static atomic_uint_fast64_t blocks = 0;
+static atomic_uint_fast64_t overruns = 0;
+static atomic_uint_fast64_t underruns = 0;
+static atomic_uint_fast64_t fill[ADC_FILL_BINS];
+
+/* Reader: only drains the FIFO into the ring */
 
 static void * adc_thread(void *arg) {
     control_set_rx_rate(ADC_RATE);
     control_rx_enable();
 
     while (true) {
-        int res = read(fd, samples, sizeof(samples));
+        bool    play = iq_play_is_on();
+        int     res = play ? iq_play_read(batch, ADC_BATCH) : backend->adc_read(batch, ADC_BATCH);
+
+        if (res <= 0) {
+            continue;
+        }
+
+        size_t samples = res / sizeof(float complex);
+
+        if (!play) {
+            iq_capture_put(batch, samples);
+        }
+
+        for (size_t i = 0; i < samples; i += ADC_SAMPLES) {
+            size_t n = samples - i;
+
+            if (n > ADC_SAMPLES) {
+                n = ADC_SAMPLES;
+            }
+
+            in_block.samples = n;
+            memcpy(in_block.data, &batch[i], n * sizeof(float complex));
+
+            /* A file waits for the DSP instead of being dropped */
+
+            while ((play || backend->blocking) && ring_free(ring) < sizeof(in_block)) {
+                usleep(1000);
+            }
+
+            if (ring_write(ring, &in_block, sizeof(in_block))) {
+                sem_post(&ring_sem);
+            } else {
+                atomic_fetch_add(&overruns, 1);
+            }
+        }
+    }
+}
+
+/* DSP: everything slow happens here, the reader never waits for it */
+
+static void * dsp_thread(void *arg) {
+    bool        started = false;
+    bool        stalled = false;
+
+    while (true) {
+        struct timespec ts;
 
-        if (res > 0) {
-            dsp_adc(samples, res / sizeof(float complex));
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += ADC_STALL_MS * 1000000;
+
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+
+        /* One underrun per stall, however long it lasts */
+
+        if (sem_timedwait(&ring_sem, &ts) != 0) {
+            if (started && !stalled) {
+                atomic_fetch_add(&underruns, 1);
+                stalled = true;
+            }
+            continue;
         }
+
+        stalled = false;
+
+        size_t level = ring_used(ring) / sizeof(adc_block_t);
+        size_t bin = level * ADC_FILL_BINS / ring_blocks;
+
+        atomic_fetch_add(&fill[bin < ADC_FILL_BINS ? bin : ADC_FILL_BINS - 1], 1);
+
+        ring_read(ring, &out_block, sizeof(out_block));
+
+        started = true;
+        atomic_fetch_add(&blocks, 1);
+
+        dsp_adc(out_block.data, out_block.samples);
+    }
+}
+
+/* Reported from the UI thread when something went wrong */
+
+static void stats_timer_cb(lv_timer_t *t) {
+    static uint64_t prev = 0;
+    adc_stats_t     stats;
+
+    adc_get_stats(&stats);
+
+    uint64_t errors = stats.overruns + stats.underruns;
+
+    if (errors == prev) {
+        return;
+    }
+
+    prev = errors;
+
+    LV_LOG_WARN("ADC %llu blocks, %llu overruns, %llu underruns, fill %llu %llu %llu %llu %llu %llu %llu %llu",
+        (unsigned long long) stats.blocks, (unsigned long long) stats.overruns,
+        (unsigned long long) stats.underruns,
+        (unsigned long long) stats.fill[0], (unsigned long long) stats.fill[1],
+        (unsigned long long) stats.fill[2], (unsigned long long) stats.fill[3],
+        (unsigned long long) stats.fill[4], (unsigned long long) stats.fill[5],
+        (unsigned long long) stats.fill[6], (unsigned long long) stats.fill[7]);
+}
+
+static void thread_start(void *(*fn)(void *), options_thread_t *opt, const char *name) {
+    pthread_t thread;
+
+    pthread_create(&thread, NULL, fn, NULL);
+
+    if (!thread_set_rt(thread, opt->prio, opt->affinity)) {
+        LV_LOG_WARN("Unable to set %s thread priority %i, affinity %02X", name, opt->prio, opt->affinity);
     }
+
+    pthread_detach(thread);
 }
 
 bool adc_init() {
     /* Stream */
 
-    fd = open("/dev/axis_fifo_0x43c10000", O_RDONLY);
+    if (!backend->adc_open()) {
+        return false;
+    }
+
+    ring = ring_create(ADC_RING_SIZE);
 
-    if (fd < 1) {
-        LV_LOG_ERROR("Unable to open ADC stream device file");
+    if (!ring) {
+        LV_LOG_ERROR("Unable to allocate ADC ring");
         return false;
     }
 
-    pthread_t thread;
+    ring_blocks = ADC_RING_SIZE / sizeof(adc_block_t);
+    sem_init(&ring_sem, 0, 0);
 
-    pthread_create(&thread, NULL, adc_thread, NULL);
-    pthread_detach(thread);
+    thread_start(dsp_thread, &options->threads.dsp, "DSP");
+    thread_start(adc_thread, &options->threads.adc, "ADC");
+
+    lv_timer_create(stats_timer_cb, ADC_STATS_MS, NULL);
 
     return true;
 }
+
+void adc_get_stats(adc_stats_t *stats) {
+    stats->blocks = atomic_load(&blocks);
+    stats->overruns = atomic_load(&overruns);
+    stats->underruns = atomic_load(&underruns);
+
+    for (int i = 0; i < ADC_FILL_BINS; i++) {
+        stats->fill[i] = atomic_load(&fill[i]);
+    }
+}
@@ -8,7 +8,19 @@
 
 #pragma once
 
-#define ADC_SAMPLES (512 / sizeof(float))
-#define ADC_RATE    (12800)
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ADC_SAMPLES     (512 / sizeof(float))
+#define ADC_RATE        (12800)
+#define ADC_FILL_BINS   8
+
+typedef struct {
+    uint64_t    blocks;
+    uint64_t    overruns;               /* Blocks dropped, the ring was full */
+    uint64_t    underruns;              /* Times the stream stalled */
+    uint64_t    fill[ADC_FILL_BINS];    /* Ring level seen by the DSP thread, in eighths */
+} adc_stats_t;
 
 bool adc_init();
+void adc_get_stats(adc_stats_t *stats);
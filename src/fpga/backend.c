@@ -0,0 +1,27 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include "lvgl/lvgl.h"
+#include "src/settings/options.h"
+#include "backend.h"
+
+const backend_t *backend = &backend_hw;
+
+void backend_init() {
+    switch (options->backend.type) {
+        case BACKEND_FILE:
+            backend = &backend_file;
+            break;
+
+        default:
+            backend = &backend_hw;
+            break;
+    }
+
+    LV_LOG_USER("Backend %s", backend->name);
+}
@@ -0,0 +1,61 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <complex.h>
+
+/*
+ * Front-end the FPGA code talks to. "hw" is the radio itself, "file" replays
+ * recorded IQ and FFT frames and throws TX away. Selected and set up by the
+ * backend section of options.yaml, backend_init() runs before the FPGA modules.
+ * GPIO and IIO are not behind it and still need the radio
+ */
+
+typedef struct {
+    uint32_t    enable;
+    uint32_t    adc_dds_step;
+    uint32_t    adc_rate;
+    uint32_t    fft_dds_step;
+    uint32_t    fft_rate;
+    uint32_t    dac_dds_step;
+    uint32_t    dac_rate;
+} trx_reg_t;
+
+typedef struct {
+    const char      *name;
+
+    /* ADC source can wait for the DSP, nothing is lost by not reading it */
+    bool            blocking;
+
+    /* Control registers */
+    trx_reg_t *     (*control_open)();
+
+    /* ADC stream, like read(): bytes or <= 0 */
+    bool            (*adc_open)();
+    int             (*adc_read)(float complex *data, size_t size);
+
+    /* DAC sink, like write(): blocks while the sink is full */
+    bool            (*dac_open)();
+    int             (*dac_write)(const float complex *data, size_t size);
+
+    /* FFT frames: waits for a count other than last, NULL on timeout */
+    bool            (*fft_open)();
+    const float *   (*fft_wait)(uint32_t last, uint32_t *count);
+    bool            (*fft_irq)();
+} backend_t;
+
+extern const backend_t  *backend;
+
+extern const backend_t  backend_hw;
+extern const backend_t  backend_file;
+
+void backend_init();
@@ -0,0 +1,199 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <unistd.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lvgl/lvgl.h"
+#include "src/util.h"
+#include "src/iq_file.h"
+#include "src/settings/options.h"
+#include "backend.h"
+#include "mb_data.h"
+#include "adc.h"
+#include "dac.h"
+
+#define FILE_FPS        25
+#define FILE_IDLE_US    100000
+
+static trx_reg_t        regs;
+
+static iq_reader_t      *iq_reader = NULL;
+static FILE             *fft_file = NULL;
+static bool             fast = false;
+static bool             loop = false;
+static uint32_t         fft_period;
+
+static uint64_t         iq_time = 0;
+static uint64_t         dac_time = 0;
+static uint64_t         fft_time = 0;
+
+static float            fft_frame[FFT_SAMPLES];
+static uint32_t         fft_count = 0;
+
+/* Sleep until the stream time catches up with the wall clock */
+
+static void pace(uint64_t *time, uint64_t duration) {
+    uint64_t now = get_time_us();
+
+    if (*time == 0 || now > *time + 1000000) {
+        *time = now;
+    }
+
+    *time += duration;
+
+    if (*time > now) {
+        usleep(*time - now);
+    }
+}
+
+static const char * get_path(const char *path, const char *name) {
+    if (path[0] == '\0') {
+        LV_LOG_WARN("No backend %s file, no data", name);
+        return NULL;
+    }
+
+    return path;
+}
+
+static FILE * open_path(const char *path, const char *name) {
+    if (!get_path(path, name)) {
+        return NULL;
+    }
+
+    FILE *f = fopen(path, "rb");
+
+    if (!f) {
+        LV_LOG_ERROR("Can not open %s", path);
+    }
+
+    return f;
+}
+
+/* Read all or nothing, starting over at the end if asked to */
+
+static bool read_items(FILE *f, void *data, size_t item, size_t count) {
+    if (fread(data, item, count, f) == count) {
+        return true;
+    }
+
+    if (loop && fseek(f, 0, SEEK_SET) == 0) {
+        return fread(data, item, count, f) == count;
+    }
+
+    return false;
+}
+
+/* Control */
+
+static trx_reg_t * control_open() {
+    uint8_t fps = options->backend.fft_fps;
+
+    fast = options->backend.fast;
+    loop = options->backend.loop;
+    fft_period = 1000000 / (fps ? fps : FILE_FPS);
+
+    memset(&regs, 0, sizeof(regs));
+
+    return &regs;
+}
+
+/* ADC */
+
+static bool adc_open() {
+    const char *path = get_path(options->backend.iq, "iq");
+
+    if (path) {
+        iq_reader = iq_reader_open(path);
+    }
+
+    return true;
+}
+
+static int adc_read(float complex *data, size_t size) {
+    /* Block by block, like the FIFO does */
+
+    if (size > ADC_SAMPLES) {
+        size = ADC_SAMPLES;
+    }
+
+    size_t res = iq_reader ? iq_reader_read(iq_reader, data, size) : 0;
+
+    if (res == 0 && iq_reader && loop && iq_reader_rewind(iq_reader)) {
+        res = iq_reader_read(iq_reader, data, size);
+    }
+
+    if (res == 0) {
+        usleep(FILE_IDLE_US);
+        return 0;
+    }
+
+    size = res;
+
+    if (!fast) {
+        pace(&iq_time, (uint64_t) size * 1000000 / ADC_RATE);
+    }
+
+    return size * sizeof(float complex);
+}
+
+/* DAC, thrown away at the real rate */
+
+static bool dac_open() {
+    return true;
+}
+
+static int dac_write(const float complex *data, size_t size) {
+    pace(&dac_time, (uint64_t) size * 1000000 / DAC_RATE);
+
+    return size * sizeof(float complex);
+}
+
+/* FFT */
+
+static bool fft_open() {
+    fft_file = open_path(options->backend.fft, "fft");
+
+    return true;
+}
+
+static const float * fft_wait(uint32_t last, uint32_t *count) {
+    if (!fft_file || !read_items(fft_file, fft_frame, sizeof(float), FFT_SAMPLES)) {
+        usleep(FILE_IDLE_US);
+        return NULL;
+    }
+
+    if (!fast) {
+        pace(&fft_time, fft_period);
+    }
+
+    *count = ++fft_count;
+
+    return fft_frame;
+}
+
+static bool fft_irq() {
+    return false;
+}
+
+const backend_t backend_file = {
+    .name = "file",
+    .blocking = true,
+    .control_open = control_open,
+    .adc_open = adc_open,
+    .adc_read = adc_read,
+    .dac_open = dac_open,
+    .dac_write = dac_write,
+    .fft_open = fft_open,
+    .fft_wait = fft_wait,
+    .fft_irq = fft_irq
+};
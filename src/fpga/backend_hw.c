@@ -0,0 +1,360 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <unistd.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lvgl/lvgl.h"
+#include "backend.h"
+#include "mb_data.h"
+
+#define FW_DIR "/usr/share/brass/fw/"
+#define MB_CRC_FILE     "/tmp/brass_mb_code.crc"
+#define MB_BRAM_SIZE    0x10000
+
+#define IRQ_TIMEOUT_MS  100     /* Wait for an interrupt, then look at the counter anyway */
+#define IRQ_MISSED_MAX  10      /* Frames seen without an interrupt before going to polling */
+#define POLL_US         5000
+
+static int              reg_fd;
+static int              adc_fd;
+static int              dac_fd;
+static int              fd_i;
+static int              fd_d;
+
+static uint8_t          *bram_i;
+static uint8_t          *bram_d;
+
+typedef struct {
+    uint32_t    *data;
+    size_t      words;
+    uint32_t    crc;
+} mb_image_t;
+
+static bool             irq = false;
+static uint8_t          irq_missed = 0;
+
+/* Control */
+
+static trx_reg_t * control_open() {
+    reg_fd = open("/dev/uio0", O_RDWR | O_SYNC);
+
+    if (reg_fd < 1) {
+        LV_LOG_ERROR("Unable to open config device file");
+        return NULL;
+    }
+
+    trx_reg_t *reg = (trx_reg_t *) mmap(NULL, 0x10000, PROT_READ | PROT_WRITE, MAP_SHARED, reg_fd, 0);
+
+    if (reg == MAP_FAILED) {
+        close(reg_fd);
+        LV_LOG_ERROR("Failed to mmap config reg");
+        return NULL;
+    }
+
+    return reg;
+}
+
+/* ADC */
+
+static bool adc_open() {
+    adc_fd = open("/dev/axis_fifo_0x43c10000", O_RDONLY);
+
+    if (adc_fd < 1) {
+        LV_LOG_ERROR("Unable to open ADC stream device file");
+        return false;
+    }
+
+    return true;
+}
+
+static int adc_read(float complex *data, size_t size) {
+    return read(adc_fd, data, size * sizeof(float complex));
+}
+
+/* DAC */
+
+static bool dac_open() {
+    dac_fd = open("/dev/axis_fifo_0x43c10000", O_WRONLY);
+
+    if (dac_fd < 1) {
+        LV_LOG_ERROR("Unable to open DAC stream device file");
+        return false;
+    }
+
+    return true;
+}
+
+static int dac_write(const float complex *data, size_t size) {
+    return write(dac_fd, data, size * sizeof(float complex));
+}
+
+/* MicroBlaze FFT */
+
+static uint32_t crc32_words(const uint32_t *data, size_t words) {
+    static uint32_t table[256];
+
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+            }
+            table[i] = c;
+        }
+    }
+
+    const uint8_t   *p = (const uint8_t *) data;
+    uint32_t        crc = 0xFFFFFFFF;
+
+    for (size_t i = 0; i < words * 4; i++) {
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+/* Whole image in one read(), already in BRAM word order */
+
+static bool image_load(const char *filename, mb_image_t *image, bool swap) {
+    int fd = open(filename, O_RDONLY);
+
+    if (fd < 0) {
+        LV_LOG_ERROR("Can not open %s", filename);
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || st.st_size > MB_BRAM_SIZE) {
+        LV_LOG_ERROR("Wrong size of %s", filename);
+        close(fd);
+        return false;
+    }
+
+    image->words = (st.st_size + 3) / 4;
+    image->data = calloc(image->words, sizeof(uint32_t));
+
+    bool ok = read(fd, image->data, st.st_size) == st.st_size;
+
+    close(fd);
+
+    if (!ok) {
+        LV_LOG_ERROR("Can not read %s", filename);
+        free(image->data);
+        return false;
+    }
+
+    if (swap) {
+        for (size_t i = 0; i < image->words; i++) {
+            image->data[i] = __builtin_bswap32(image->data[i]);
+        }
+    }
+
+    image->crc = crc32_words(image->data, image->words);
+
+    return true;
+}
+
+/* Uncached BRAM: 32-bit accesses only, bulk read back for the CRC */
+
+static void bram_write(uint8_t *bram, const uint32_t *data, size_t words) {
+    volatile uint32_t *dst = (volatile uint32_t *) bram;
+
+    for (size_t i = 0; i < words; i++) {
+        dst[i] = data[i];
+    }
+}
+
+static uint32_t bram_crc(const uint8_t *bram, size_t words) {
+    static uint32_t         buf[MB_BRAM_SIZE / 4];
+    const volatile uint32_t *src = (const volatile uint32_t *) bram;
+
+    for (size_t i = 0; i < words; i++) {
+        buf[i] = src[i];
+    }
+
+    return crc32_words(buf, words);
+}
+
+static bool mb_load(const char *filename, uint8_t *bram, const mb_image_t *image) {
+    bram_write(bram, image->data, image->words);
+
+    if (bram_crc(bram, image->words) != image->crc) {
+        LV_LOG_ERROR("%s verify failed", filename);
+        return false;
+    }
+
+    LV_LOG_INFO("%s loaded, %zu words, CRC %08X", filename, image->words, image->crc);
+
+    return true;
+}
+
+/*
+ * MB is held in reset while loading. The data is changed by running, so it is
+ * always loaded. The code is skipped when it matches the CRC cached by the last
+ * load and the I-BRAM reads back the same
+ */
+
+static void mb_load_all() {
+    mb_image_t  code, data;
+    uint32_t    cached = 0;
+    FILE        *f;
+
+    if (image_load(FW_DIR "mb.code", &code, true)) {
+        f = fopen(MB_CRC_FILE, "r");
+
+        if (f) {
+            if (fscanf(f, "%x", &cached) != 1) {
+                cached = 0;
+            }
+            fclose(f);
+        }
+
+        if (cached == code.crc && bram_crc(bram_i, code.words) == code.crc) {
+            LV_LOG_INFO("MB code is already loaded, CRC %08X", code.crc);
+        } else if (mb_load(FW_DIR "mb.code", bram_i, &code)) {
+            f = fopen(MB_CRC_FILE, "w");
+
+            if (f) {
+                fprintf(f, "%08X\n", code.crc);
+                fclose(f);
+            }
+        } else {
+            unlink(MB_CRC_FILE);
+        }
+
+        free(code.data);
+    }
+
+    if (image_load(FW_DIR "mb.data", &data, false)) {
+        mb_load(FW_DIR "mb.data", bram_d, &data);
+        free(data.data);
+    }
+}
+
+/* UIO: writing 1 unmasks the interrupt, read() returns the interrupt count */
+
+static bool irq_enable() {
+    uint32_t on = 1;
+
+    return write(fd_d, &on, sizeof(on)) == sizeof(on);
+}
+
+static bool irq_wait() {
+    struct pollfd   pfd = { .fd = fd_d, .events = POLLIN };
+
+    if (poll(&pfd, 1, IRQ_TIMEOUT_MS) > 0) {
+        uint32_t irq_count;
+
+        read(fd_d, &irq_count, sizeof(irq_count));
+        irq_enable();
+
+        return true;
+    }
+
+    return false;
+}
+
+static bool fft_open() {
+    /* I-BRAM */
+
+    fd_i = open("/dev/uio1", O_RDWR | O_SYNC);
+
+    if (fd_i < 1) {
+        LV_LOG_ERROR("Unable to open MB I-BRAM device file");
+        return false;
+    }
+
+    bram_i = (uint8_t *) mmap(NULL, MB_BRAM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd_i, 0);
+
+    if (bram_i == MAP_FAILED) {
+        close(fd_i);
+        LV_LOG_ERROR("Failed to mmap MB I-BRAM");
+        return false;
+    }
+
+    /* D-BRAM */
+
+    fd_d = open("/dev/uio2", O_RDWR | O_SYNC);
+
+    if (fd_d < 1) {
+        LV_LOG_ERROR("Unable to open MB D-BRAM device file");
+        return false;
+    }
+
+    bram_d = (uint8_t *) mmap(NULL, MB_BRAM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd_d, 0);
+
+    if (bram_d == MAP_FAILED) {
+        close(fd_d);
+        LV_LOG_ERROR("Failed to mmap MB D-BRAM");
+        return false;
+    }
+
+    mb_load_all();
+
+    irq = irq_enable();
+
+    if (!irq) {
+        LV_LOG_WARN("MB D-BRAM interrupt not available, polling");
+    }
+
+    return true;
+}
+
+static const float * fft_wait(uint32_t last, uint32_t *count) {
+    mb_data_t *data = (mb_data_t *) bram_d;
+
+    if (irq) {
+        bool got = irq_wait();
+
+        if (data->count == last) {
+            return NULL;
+        }
+
+        if (got) {
+            irq_missed = 0;
+        } else if (++irq_missed >= IRQ_MISSED_MAX) {
+            LV_LOG_WARN("No MB interrupts, polling");
+            irq = false;
+        }
+    } else if (data->count == last) {
+        usleep(POLL_US);
+        return NULL;
+    }
+
+    *count = data->count;
+
+    return data->out;
+}
+
+static bool fft_irq() {
+    return irq;
+}
+
+const backend_t backend_hw = {
+    .name = "hw",
+    .blocking = false,
+    .control_open = control_open,
+    .adc_open = adc_open,
+    .adc_read = adc_read,
+    .dac_open = dac_open,
+    .dac_write = dac_write,
+    .fft_open = fft_open,
+    .fft_wait = fft_wait,
+    .fft_irq = fft_irq
+};
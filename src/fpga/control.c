@@ -6,70 +6,96 @@
  *  Copyright (c) 2022-2024 Belousov Oleg aka R1CBU
  */
 
-#include <fcntl.h>
 #include <unistd.h>
-#include <sys/ioctl.h>
-#include <sys/mman.h>
 #include <math.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #include "lvgl/lvgl.h"
 #include "control.h"
+#include "backend.h"
 #include "src/settings/rf.h"
 
 #define RX_ENABLE_ADC  (1 << 0)
 #define RX_ENABLE_FFT  (1 << 1)
 #define RX_ENABLE_MB   (1 << 2)
 
-typedef struct {
-    uint32_t    enable;
-    uint32_t    adc_dds_step;
-    uint32_t    adc_rate;
-    uint32_t    fft_dds_step;
-    uint32_t    fft_rate;
-    uint32_t    dac_dds_step;
-    uint32_t    dac_rate;
-} trx_reg_t;
-
-static int          reg_fd;
 static trx_reg_t    *reg;
 
 static uint64_t     rx_freq;
 static uint64_t     tx_freq;
 static uint64_t     fft_freq;
 
+static uint32_t     rx_step;
+static uint32_t     tx_step;
+static uint32_t     fft_step;
+static bool         force = false;
+
+static double       dds_scale = 0.0;
+static int32_t      dds_txo_offset;
+
+static uint64_t     dds_writes = 0;
+static uint64_t     dds_skipped = 0;
+
 void control_init() {
     /* Reg */
 
-    reg_fd = open("/dev/uio0", O_RDWR | O_SYNC);
+    reg = backend->control_open();
 
-    if (reg_fd < 1) {
-        LV_LOG_ERROR("Unable to open config device file");
+    if (!reg) {
         return;
     }
 
-    reg = (trx_reg_t *) mmap(NULL, 0x10000, PROT_READ | PROT_WRITE, MAP_SHARED, reg_fd, 0);
-
-    if (reg == MAP_FAILED) {
-        close(reg_fd);
-        LV_LOG_ERROR("Failed to mmap config reg");
-    }
-
     reg->enable = 0;
     usleep(100);
 }
 
+void control_get_stats(control_stats_t *stats) {
+    stats->dds_writes = dds_writes;
+    stats->dds_skipped = dds_skipped;
+}
+
 void control_update() {
+    force = true;
     control_set_rx_freq(rx_freq);
     control_set_tx_freq(tx_freq);
     control_set_fft_freq(fft_freq);
+    force = false;
 }
 
-void control_set_rx_freq(uint64_t freq) {
-    float txo = 122880000.0f + rf->txo_offset;
+/* Step scale follows the TXO correction, the rest is one multiply */
+
+static uint32_t dds_step(uint64_t freq) {
+    if (dds_scale == 0.0 || dds_txo_offset != rf->txo_offset) {
+        dds_txo_offset = rf->txo_offset;
+        dds_scale = (double) (1 << 30) / (122880000.0 + dds_txo_offset);
+    }
+
+    return (uint32_t) floor(freq * dds_scale + 0.5);
+}
+
+/* The registers are uncached, only a changed step is written */
 
+static void dds_write(volatile uint32_t *reg_step, uint32_t *last, uint64_t freq) {
+    uint32_t step = dds_step(freq);
+
+    if (step == *last && !force) {
+        dds_skipped++;
+        return;
+    }
+
+    *reg_step = step;
+    *last = step;
+    dds_writes++;
+}
+
+void control_set_rx_freq(uint64_t freq) {
     rx_freq = freq;
-    reg->adc_dds_step = (uint32_t) floor(freq / txo * (1 << 30) + 0.5f);
+    dds_write(&reg->adc_dds_step, &rx_step, freq);
+}
+
+uint64_t control_get_rx_freq() {
+    return rx_freq;
 }
 
 void control_set_rx_rate(uint32_t rate) {
@@ -77,17 +103,17 @@ void control_set_rx_rate(uint32_t rate) {
 }
 
 void control_set_tx_freq(uint64_t freq) {
-    float txo = 122880000.0f + rf->txo_offset;
-
     tx_freq = freq;
-    reg->dac_dds_step = (uint32_t) floor(freq / txo * (1 << 30) + 0.5f);
+    dds_write(&reg->dac_dds_step, &tx_step, freq);
 }
 
 void control_set_fft_freq(uint64_t freq) {
-    float txo = 122880000.0f + rf->txo_offset;
-
     fft_freq = freq;
-    reg->fft_dds_step = (uint32_t) floor(freq / txo * (1 << 30) + 0.5f);
+    dds_write(&reg->fft_dds_step, &fft_step, freq);
+}
+
+uint64_t control_get_fft_freq() {
+    return fft_freq;
 }
 
 void control_set_fft_rate(uint32_t rate) {
@@ -10,13 +10,21 @@
 
 #include <stdint.h>
 
+typedef struct {
+    uint64_t    dds_writes;
+    uint64_t    dds_skipped;    /* Same step as already in the register */
+} control_stats_t;
+
 void control_init();
 void control_update();
+void control_get_stats(control_stats_t *stats);
 
 void control_set_rx_freq(uint64_t freq);
+uint64_t control_get_rx_freq();
 void control_set_rx_rate(uint32_t rate);
 void control_set_tx_freq(uint64_t freq);
 void control_set_fft_freq(uint64_t freq);
+uint64_t control_get_fft_freq();
 void control_set_fft_rate(uint32_t rate);
 
 void control_rx_enable();
@@ -12,50 +12,217 @@
 #include <stdio.h>
 #include <pthread.h>
 #include <string.h>
-#include <fcntl.h>
-#include <sys/ioctl.h>
-#include <sys/mman.h>
 #include <math.h>
+#include <stdatomic.h>
 
 #include "lvgl/lvgl.h"
 #include "src/dsp.h"
+#include "src/radio.h"
+#include "src/util.h"
+#include "src/settings/options.h"
 #include "src/hw/gpio.h"
 #include "dac.h"
+#include "backend.h"
 
-static int              fd;
-static float complex    samples[DAC_SAMPLES];
+#define DAC_BATCH_MAX   8
+#define DAC_PREFILL     2
+#define DAC_STATS_MS    5000
+
+static float complex    samples[DAC_SAMPLES * DAC_BATCH_MAX];
+
+static pthread_mutex_t  mux = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   cond = PTHREAD_COND_INITIALIZER;
+static uint64_t         ptt_time = 0;
+static bool             wake = false;
+static uint64_t         drain_time = 0;
+
+static atomic_uint_fast64_t tx = 0;
+static atomic_uint_fast64_t underruns_est = 0;
+static atomic_uint_fast64_t starved = 0;
+static atomic_uint_fast64_t write_errors = 0;
+static atomic_uint_fast32_t latency_last = 0;
+static atomic_uint_fast32_t latency_max = 0;
+
+static uint8_t blocks_option(uint8_t x, uint8_t def) {
+    if (x == 0) {
+        return def;
+    }
+
+    return x > DAC_BATCH_MAX ? DAC_BATCH_MAX : x;
+}
+
+/* Modulator output for a number of blocks. Missing data goes out as silence, so the FIFO is kept fed */
+
+static size_t produce(uint8_t blocks) {
+    size_t total = 0;
+
+    for (uint8_t i = 0; i < blocks; i++) {
+        float complex   *data = &samples[total];
+        size_t          size = dsp_dac(data, DAC_SAMPLES);
+
+        if (size == 0) {
+            memset(data, 0, DAC_SAMPLES * sizeof(float complex));
+            size = DAC_SAMPLES;
+            atomic_fetch_add(&starved, 1);
+        }
+
+        total += size;
+    }
+
+    return total;
+}
+
+static void fifo_write(size_t size) {
+    uint64_t    now = get_time_us();
+    size_t      bytes = size * sizeof(float complex);
+
+    /*
+     * Everything written so far should have been played by drain_time. There is
+     * no FIFO level register, so an underrun is only estimated from the clock
+     */
+
+    if (drain_time) {
+        if (now > drain_time) {
+            atomic_fetch_add(&underruns_est, 1);
+            drain_time = now;
+        }
+    } else {
+        drain_time = now;
+    }
+
+    int res = backend->dac_write(samples, size);
+
+    if (res != bytes) {
+        atomic_fetch_add(&write_errors, 1);
+        LV_LOG_WARN("DAC write %i of %zu bytes", res, bytes);
+    }
+
+    drain_time += (uint64_t) size * 1000000 / DAC_RATE;
+}
 
 static void * dac_thread(void *arg) {
+    bool on_air = false;
+
     while (true) {
-        size_t size = dsp_dac(samples, DAC_SAMPLES);
+        if (radio_get_state() == RADIO_RX) {
+            if (on_air) {
+                dsp_dac(samples, DAC_SAMPLES);
+
+                memset(samples, 0, DAC_SAMPLES * sizeof(float complex));
+                backend->dac_write(samples, DAC_SAMPLES);
+
+                on_air = false;
+            }
+
+            /* Sleeps through RX, leaving it goes through dac_ptt() or dac_wake() */
 
-        if (size > 0) {
-            int res = write(fd, samples, size * sizeof(float complex));
+            pthread_mutex_lock(&mux);
 
-            if (res != size * sizeof(float complex)) {
-                LV_LOG_WARN("Fix me");
+            while (ptt_time == 0 && !wake && radio_get_state() == RADIO_RX) {
+                pthread_cond_wait(&cond, &mux);
             }
-        } else {
-            memset(samples, 0, sizeof(samples));
-            write(fd, samples, sizeof(samples));
+
+            wake = false;
+            pthread_mutex_unlock(&mux);
+            continue;
+        }
+
+        if (!on_air) {
+            pthread_mutex_lock(&mux);
+            uint64_t start = ptt_time ? ptt_time : get_time_us();
+            ptt_time = 0;
+            pthread_mutex_unlock(&mux);
+
+            on_air = true;
+            drain_time = 0;
+            atomic_fetch_add(&tx, 1);
+
+            fifo_write(produce(blocks_option(options->dac.prefill, DAC_PREFILL)));
+
+            uint32_t latency = get_time_us() - start;
+
+            atomic_store(&latency_last, latency);
+
+            if (latency > atomic_load(&latency_max)) {
+                atomic_store(&latency_max, latency);
+            }
+            continue;
         }
+
+        fifo_write(produce(blocks_option(options->dac.batch, 1)));
     }
 }
 
+/* After a transmission, or when something went wrong meanwhile */
+
+static void stats_timer_cb(lv_timer_t *t) {
+    static uint64_t prev_tx = 0;
+    static uint64_t prev_errors = 0;
+    dac_stats_t     stats;
+
+    dac_get_stats(&stats);
+
+    uint64_t errors = stats.underruns_est + stats.starved + stats.write_errors;
+
+    if (stats.tx == prev_tx && errors == prev_errors) {
+        return;
+    }
+
+    if (errors != prev_errors) {
+        LV_LOG_WARN("DAC %llu TX, ~%llu underruns, %llu starved, %llu write errors, latency %u us, max %u us",
+            (unsigned long long) stats.tx, (unsigned long long) stats.underruns_est,
+            (unsigned long long) stats.starved, (unsigned long long) stats.write_errors,
+            stats.latency_last, stats.latency_max);
+    } else {
+        LV_LOG_INFO("DAC %llu TX, latency %u us, max %u us",
+            (unsigned long long) stats.tx, stats.latency_last, stats.latency_max);
+    }
+
+    prev_tx = stats.tx;
+    prev_errors = errors;
+}
+
 bool dac_init() {
     /* Stream */
 
-    fd = open("/dev/axis_fifo_0x43c10000", O_WRONLY);
-
-    if (fd < 1) {
-        LV_LOG_ERROR("Unable to open DAC stream device file");
+    if (!backend->dac_open()) {
         return false;
     }
 
     pthread_t thread;
 
     pthread_create(&thread, NULL, dac_thread, NULL);
+
+    if (!thread_set_rt(thread, options->threads.dac.prio, options->threads.dac.affinity)) {
+        LV_LOG_WARN("Unable to set DAC thread priority %i, affinity %02X", options->threads.dac.prio, options->threads.dac.affinity);
+    }
+
     pthread_detach(thread);
 
+    lv_timer_create(stats_timer_cb, DAC_STATS_MS, NULL);
+
     return true;
 }
+
+void dac_ptt() {
+    pthread_mutex_lock(&mux);
+    ptt_time = get_time_us();
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&mux);
+}
+
+void dac_wake() {
+    pthread_mutex_lock(&mux);
+    wake = true;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&mux);
+}
+
+void dac_get_stats(dac_stats_t *stats) {
+    stats->tx = atomic_load(&tx);
+    stats->underruns_est = atomic_load(&underruns_est);
+    stats->starved = atomic_load(&starved);
+    stats->write_errors = atomic_load(&write_errors);
+    stats->latency_last = atomic_load(&latency_last);
+    stats->latency_max = atomic_load(&latency_max);
+}
@@ -8,7 +8,22 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #define DAC_SAMPLES (512 / sizeof(float))
 #define DAC_RATE    (12800)
 
+typedef struct {
+    uint64_t    tx;                 /* Transmissions started */
+    uint64_t    underruns_est;      /* The FIFO likely ran dry during TX, from the write timing */
+    uint64_t    starved;            /* Blocks the modulator had nothing for, sent as silence */
+    uint64_t    write_errors;
+    uint32_t    latency_last;       /* PTT to the prefill written, us */
+    uint32_t    latency_max;
+} dac_stats_t;
+
 bool dac_init();
+void dac_ptt();
+void dac_wake();     /* Leaving RX other than by PTT */
+void dac_get_stats(dac_stats_t *stats);
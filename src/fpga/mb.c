@@ -11,113 +11,112 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
-#include <fcntl.h>
-#include <sys/mman.h>
 #include <math.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 #include "lvgl/lvgl.h"
 #include "src/dsp.h"
+#include "src/util.h"
+#include "src/fft_capture.h"
+#include "src/fft_play.h"
 #include "mb.h"
 #include "mb_data.h"
 #include "control.h"
+#include "backend.h"
 
-#define FW_DIR "/usr/share/brass/fw/"
+#define MB_STATS_MS     5000
 
-static int              fd_i;
-static int              fd_d;
+static uint32_t         count = 0;
+static bool             count_valid = false;
 
-static uint8_t          *bram_i;
-static uint8_t          *bram_d;
+static atomic_uint_fast64_t frames = 0;
+static atomic_uint_fast64_t skipped = 0;
+static atomic_uint_fast64_t frame_time = 0;
+static atomic_uint_fast64_t interval_sum = 0;
+static atomic_uint_fast64_t intervals = 0;
+static atomic_uint_fast32_t interval_max = 0;
 
-static uint32_t         count = 0;
+static void * mb_thread(void *arg) {
+    while (true) {
+        if (fft_play_is_on()) {
+            const float *out = fft_play_wait();
 
-void mb_load(const char *filename, uint8_t *bram, bool swap) {
-    int fd = open(filename, O_RDONLY);
+            if (out) {
+                dsp_fft((float *) out);
+            }
 
-    if (fd > 0) {
-        uint8_t buf[4];
+            count_valid = false;
+            continue;
+        }
 
-        while (1) {
-            int res = read(fd, buf, sizeof(buf));
+        uint32_t    c;
+        const float *out = backend->fft_wait(count, &c);
 
-            if (res <= 0) {
-                break;
-            }
+        if (!out) {
+            continue;
+        }
 
-            if (swap) {
-                *bram = buf[3]; bram++;
-                *bram = buf[2]; bram++;
-                *bram = buf[1]; bram++;
-                *bram = buf[0]; bram++;
-            } else {
-                *bram = buf[0]; bram++;
-                *bram = buf[1]; bram++;
-                *bram = buf[2]; bram++;
-                *bram = buf[3]; bram++;
-            }
+        /* MB bumps the counter once per FFT, a gap means frames were overwritten before we came */
+
+        if (count_valid && c - count > 1) {
+            atomic_fetch_add(&skipped, c - count - 1);
         }
 
-        LV_LOG_INFO("%s loaded", filename);
-        close(fd);
-    } else {
-        LV_LOG_ERROR("Can not open %s", filename);
-    }
-}
+        uint64_t now = get_time_us();
 
-static void * mb_thread(void *arg) {
-    mb_data_t   *data = (mb_data_t *) bram_d;
+        if (count_valid) {
+            uint32_t interval = now - atomic_load(&frame_time);
 
-    while (true) {
-        if (data->count != count) {
-            dsp_fft(data->out);
-            count = data->count;
-        } else {
-            usleep(5000);
+            atomic_fetch_add(&interval_sum, interval);
+            atomic_fetch_add(&intervals, 1);
+
+            if (interval > atomic_load(&interval_max)) {
+                atomic_store(&interval_max, interval);
+            }
         }
-    }
-}
 
-bool mb_init() {
-    /* I-BRAM */
+        atomic_store(&frame_time, now);
+        atomic_fetch_add(&frames, 1);
 
-    fd_i = open("/dev/uio1", O_RDWR | O_SYNC);
+        fft_capture_put(out);
+        dsp_fft((float *) out);
 
-    if (fd_i < 1) {
-        LV_LOG_ERROR("Unable to open MB I-BRAM device file");
-        return false;
+        count = c;
+        count_valid = true;
     }
+}
 
-    bram_i = (uint8_t *) mmap(NULL, 0x10000, PROT_READ | PROT_WRITE, MAP_SHARED, fd_i, 0);
+static void stats_timer_cb(lv_timer_t *t) {
+    static uint64_t prev_skipped = 0;
+    static uint64_t prev_sum = 0;
+    static uint64_t prev_intervals = 0;
+    mb_stats_t      stats;
 
-    if (bram_i == MAP_FAILED) {
-        close(fd_i);
-        LV_LOG_ERROR("Failed to mmap MB I-BRAM");
-        return false;
-    }
+    mb_get_stats(&stats);
 
-    /* D-BRAM */
+    uint64_t sum = stats.interval_sum - prev_sum;
+    uint64_t n = stats.intervals - prev_intervals;
 
-    fd_d = open("/dev/uio2", O_RDWR | O_SYNC);
+    prev_sum = stats.interval_sum;
+    prev_intervals = stats.intervals;
 
-    if (fd_d < 1) {
-        LV_LOG_ERROR("Unable to open MB D-BRAM device file");
-        return false;
+    if (stats.skipped == prev_skipped) {
+        return;
     }
 
-    bram_d = (uint8_t *) mmap(NULL, 0x10000, PROT_READ | PROT_WRITE, MAP_SHARED, fd_d, 0);
+    prev_skipped = stats.skipped;
+
+    LV_LOG_WARN("MB %llu frames, %llu skipped, interval %llu us, max %u us",
+        (unsigned long long) stats.frames, (unsigned long long) stats.skipped,
+        (unsigned long long) (n ? sum / n : 0), stats.interval_max);
+}
 
-    if (bram_d == MAP_FAILED) {
-        close(fd_d);
-        LV_LOG_ERROR("Failed to mmap MB D-BRAM");
+bool mb_init() {
+    if (!backend->fft_open()) {
         return false;
     }
 
-    mb_load(FW_DIR "mb.code", bram_i, true);
-    mb_load(FW_DIR "mb.data", bram_d, false);
-
-    /* * */
-
     control_mb_enable();
     control_fft_enable();
 
@@ -126,9 +125,17 @@ bool mb_init() {
     pthread_create(&thread, NULL, mb_thread, NULL);
     pthread_detach(thread);
 
+    lv_timer_create(stats_timer_cb, MB_STATS_MS, NULL);
+
     return true;
 }
 
-void * mb_data() {
-    return bram_d;
+void mb_get_stats(mb_stats_t *stats) {
+    stats->frames = atomic_load(&frames);
+    stats->skipped = atomic_load(&skipped);
+    stats->frame_time = atomic_load(&frame_time);
+    stats->interval_sum = atomic_load(&interval_sum);
+    stats->intervals = atomic_load(&intervals);
+    stats->interval_max = atomic_load(&interval_max);
+    stats->irq = backend->fft_irq();
 }
@@ -9,6 +9,17 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint64_t    frames;
+    uint64_t    skipped;        /* Frames the MB made, but we never saw */
+    uint64_t    frame_time;     /* Last frame, CLOCK_MONOTONIC us */
+    uint64_t    interval_sum;   /* Between frames seen, us */
+    uint64_t    intervals;
+    uint32_t    interval_max;
+    bool        irq;
+} mb_stats_t;
 
 bool mb_init();
-void * mb_data();
+void mb_get_stats(mb_stats_t *stats);
@@ -75,37 +75,27 @@ static void hkey_send(hkey_state_t event) {
     }
 }
 
-void hkey_put(uint16_t x, uint16_t y) {
-    int16_t xi = -1;
-    int16_t yi = -1;
-
+static int16_t find_x(uint16_t x) {
     for (int i = 0; i < 7; i++) {
         if (x < options->hkeys.x[i]) {
-            xi = i;
-            break;
+            return i;
         }
     }
 
+    return -1;
+}
+
+static int16_t find_y(uint16_t y) {
     for (int i = 0; i < 5; i++) {
         if (y < options->hkeys.y[i]) {
-            yi = i;
-            break;
+            return i;
         }
     }
 
-    hist_x[hist] = xi;
-    hist_y[hist] = yi;
-
-    hist = (hist + 1) % 3;
-
-    for (int i = 0; i < 2; i++)
-        if (hist_x[i] != hist_x[i + 1])
-            return;
-
-    for (int i = 0; i < 2; i++)
-        if (hist_y[i] != hist_y[i + 1])
-            return;
+    return -1;
+}
 
+static void hkey_update(int16_t xi, int16_t yi) {
     uint64_t now = get_time();
 
     if (xi >= 0 && yi >= 0) {
@@ -146,3 +136,42 @@ void hkey_put(uint16_t x, uint16_t y) {
         }
     }
 }
+
+void hkey_put(uint16_t x, uint16_t y) {
+    int16_t xi = find_x(x);
+    int16_t yi = find_y(y);
+
+    hist_x[hist] = xi;
+    hist_y[hist] = yi;
+
+    hist = (hist + 1) % 3;
+
+    for (int i = 0; i < 2; i++)
+        if (hist_x[i] != hist_x[i + 1])
+            return;
+
+    for (int i = 0; i < 2; i++)
+        if (hist_y[i] != hist_y[i + 1])
+            return;
+
+    hkey_update(xi, yi);
+}
+
+/* A block counts only when every sample in it reads the same key */
+
+void hkey_put_block(const uint16_t *x, const uint16_t *y, size_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    int16_t xi = find_x(x[0]);
+    int16_t yi = find_y(y[0]);
+
+    for (size_t i = 1; i < n; i++) {
+        if (find_x(x[i]) != xi || find_y(y[i]) != yi) {
+            return;
+        }
+    }
+
+    hkey_update(xi, yi);
+}
@@ -8,5 +8,7 @@
 
 #pragma once
 #include <stdint.h>
+#include <stddef.h>
 
 void hkey_put(uint16_t x, uint16_t y);
+void hkey_put_block(const uint16_t *x, const uint16_t *y, size_t n);
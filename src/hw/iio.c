@@ -7,20 +7,126 @@
  */
 
 #include <unistd.h>
+#include <stdio.h>
+#include <math.h>
+#include <errno.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
 #include <iio.h>
 
 #include "lvgl/lvgl.h"
 #include "iio.h"
 #include "src/hkey.h"
+#include "src/settings/options.h"
+
+#define IIO_RATE        400         /* Scans of the four ADS1015 channels per second */
+#define IIO_BLOCK       8           /* Scans per buffer refill */
+#define IIO_BLOCK_MAX   64
+#define POLL_RATE       1000        /* Without a buffer */
+#define PWR_RATE        20          /* Power and SWR updates per second */
+#define PWR_MIN_V       0.05f       /* Less forward than this is no carrier */
+
+#define TRIGGER_NAME    "brass"
+#define TRIGGER_DIR     "/sys/kernel/config/iio/triggers/hrtimer/" TRIGGER_NAME
 
 static struct iio_channel  *vref = NULL;
 static struct iio_channel  *hkeys_x = NULL;
 static struct iio_channel  *hkeys_y = NULL;
 static struct iio_channel  *pwr_ref = NULL;
 static struct iio_channel  *pwr_fwd = NULL;
+static int32_t             vref_value = -1;
+
+static struct iio_buffer   *buf = NULL;
+static uint16_t            block;
+
+/* Power, decimated to PWR_RATE */
+
+static double              ref_scale = 0.001;  /* V per count */
+static double              fwd_scale = 0.001;
+static int64_t             ref_sum = 0;
+static int64_t             fwd_sum = 0;
+static uint32_t            pwr_count = 0;
+static uint32_t            pwr_samples;
+
+static pthread_mutex_t     pwr_mux = PTHREAD_MUTEX_INITIALIZER;
+static iio_power_t         pwr;
+static uint32_t            pwr_seq = 0;
+static uint32_t            pwr_stale_seq = 0;
+static atomic_bool         pwr_restart = false;
+
+static void power_add(int32_t ref, int32_t fwd) {
+    if (atomic_exchange(&pwr_restart, false)) {
+        ref_sum = 0;
+        fwd_sum = 0;
+        pwr_count = 0;
+    }
+
+    ref_sum += ref;
+    fwd_sum += fwd;
+
+    if (++pwr_count < pwr_samples) {
+        return;
+    }
+
+    float   ref_v = ref_sum * ref_scale / pwr_count;
+    float   fwd_v = fwd_sum * fwd_scale / pwr_count;
+    float   scale = options->iio.pwr_scale > 0.0f ? options->iio.pwr_scale : 1.0f;
+    float   swr = 1.0f;
+
+    if (fwd_v > PWR_MIN_V) {
+        float g = ref_v / fwd_v;
+
+        swr = g < 0.99f ? (1.0f + g) / (1.0f - g) : 199.0f;
+    }
+
+    pthread_mutex_lock(&pwr_mux);
+    pwr.fwd = fwd_v * fwd_v * scale;
+    pwr.ref = ref_v * ref_v * scale;
+    pwr.swr = swr;
+    pwr_seq++;
+    pthread_mutex_unlock(&pwr_mux);
+
+    ref_sum = 0;
+    fwd_sum = 0;
+    pwr_count = 0;
+}
+
+static uint16_t clip(int16_t x) {
+    return x < 0 ? 0 : x;
+}
+
+/* Buffered: the kernel scans on the trigger, one refill per block */
+
+static void * buffer_thread(void *arg) {
+    int16_t     data[4][IIO_BLOCK_MAX];
+    uint16_t    x[IIO_BLOCK_MAX];
+    uint16_t    y[IIO_BLOCK_MAX];
 
-static void * iio_thread(void *arg) {
+    while (true) {
+        if (iio_buffer_refill(buf) < 0) {
+            LV_LOG_ERROR("IIO buffer refill");
+            usleep(100000);
+            continue;
+        }
+
+        size_t n = iio_channel_read(hkeys_x, buf, data[0], sizeof(data[0])) / sizeof(int16_t);
+
+        iio_channel_read(hkeys_y, buf, data[1], sizeof(data[1]));
+        iio_channel_read(pwr_ref, buf, data[2], sizeof(data[2]));
+        iio_channel_read(pwr_fwd, buf, data[3], sizeof(data[3]));
+
+        for (size_t i = 0; i < n; i++) {
+            x[i] = clip(data[0][i]);
+            y[i] = clip(data[1][i]);
+            power_add(data[2][i], data[3][i]);
+        }
+
+        hkey_put_block(x, y, n);
+    }
+}
+
+static void * poll_thread(void *arg) {
     while (true) {
         long long x, y, ref, fwd;
 
@@ -30,14 +136,53 @@ static void * iio_thread(void *arg) {
         iio_channel_attr_read_longlong(pwr_fwd, "raw", &fwd);
 
         hkey_put(x, y);
-        usleep(1000);
+        power_add(ref, fwd);
+        usleep(1000000 / POLL_RATE);
     }
 }
 
+static bool buffer_open(struct iio_context *ctx, struct iio_device *dev, uint16_t rate) {
+    struct iio_device *trigger = iio_context_find_device(ctx, TRIGGER_NAME);
+
+    if (trigger == NULL) {
+        LV_LOG_WARN("No %s trigger", TRIGGER_NAME);
+        return false;
+    }
+
+    if (iio_device_attr_write_longlong(trigger, "sampling_frequency", rate) < 0) {
+        LV_LOG_WARN("Set %s trigger rate %u", TRIGGER_NAME, rate);
+    }
+
+    if (iio_device_set_trigger(dev, trigger) < 0) {
+        LV_LOG_WARN("Set ads1015 trigger");
+        return false;
+    }
+
+    iio_channel_enable(hkeys_x);
+    iio_channel_enable(hkeys_y);
+    iio_channel_enable(pwr_ref);
+    iio_channel_enable(pwr_fwd);
+
+    buf = iio_device_create_buffer(dev, block, false);
+
+    if (buf == NULL) {
+        LV_LOG_WARN("Create ads1015 buffer");
+        return false;
+    }
+
+    return true;
+}
+
 void iio_init() {
     struct iio_context  *ctx = NULL;
     struct iio_device   *dev = NULL;
 
+    /* hrtimer trigger, before the context lists the devices */
+
+    if (mkdir(TRIGGER_DIR, 0755) < 0 && errno != EEXIST) {
+        LV_LOG_WARN("Create %s trigger", TRIGGER_NAME);
+    }
+
     ctx = iio_create_local_context();
 
     if (ctx == NULL) {
@@ -90,22 +235,84 @@ void iio_init() {
         }
     } else {
         LV_LOG_ERROR("Find ads1015");
+        return;
+    }
+
+    if (!hkeys_x || !hkeys_y || !pwr_ref || !pwr_fwd) {
+        return;
+    }
+
+    /* Counts to volts, scale is in mV */
+
+    if (iio_channel_attr_read_double(pwr_ref, "scale", &ref_scale) == 0) {
+        ref_scale /= 1000.0;
+    }
+
+    if (iio_channel_attr_read_double(pwr_fwd, "scale", &fwd_scale) == 0) {
+        fwd_scale /= 1000.0;
     }
 
     /* Thread */
 
-    pthread_t thread;
+    uint16_t    rate = options->iio.rate ? options->iio.rate : IIO_RATE;
+    void *      (*fn)(void *);
+    pthread_t   thread;
 
-    pthread_create(&thread, NULL, iio_thread, NULL);
+    block = options->iio.block ? options->iio.block : IIO_BLOCK;
+
+    if (block > IIO_BLOCK_MAX) {
+        block = IIO_BLOCK_MAX;
+    }
+
+    if (buffer_open(ctx, dev, rate)) {
+        pwr_samples = rate / PWR_RATE;
+        fn = buffer_thread;
+    } else {
+        LV_LOG_WARN("IIO buffer not available, polling");
+        pwr_samples = POLL_RATE / PWR_RATE;
+        fn = poll_thread;
+    }
+
+    if (pwr_samples == 0) {
+        pwr_samples = 1;
+    }
+
+    pthread_create(&thread, NULL, fn, NULL);
     pthread_detach(thread);
 }
 
 void iio_set_vref(uint16_t data) {
-    if (vref == NULL) {
+    if (vref == NULL || vref_value == data) {
         return;
     }
 
     if (iio_channel_attr_write_longlong(vref, "raw", data) < 0) {
         LV_LOG_ERROR("Write to VRef");
+        vref_value = -1;
+    } else {
+        vref_value = data;
     }
 }
+
+/* After a retune. The window in progress and the one not taken yet are dropped */
+
+void iio_power_restart() {
+    pthread_mutex_lock(&pwr_mux);
+    pwr_stale_seq = pwr_seq;
+    pthread_mutex_unlock(&pwr_mux);
+
+    atomic_store(&pwr_restart, true);
+}
+
+bool iio_get_power(iio_power_t *power, uint32_t *seq) {
+    pthread_mutex_lock(&pwr_mux);
+
+    bool fresh = pwr_seq != *seq && pwr_seq != pwr_stale_seq;
+
+    *power = pwr;
+    *seq = pwr_seq;
+
+    pthread_mutex_unlock(&pwr_mux);
+
+    return fresh;
+}
@@ -11,6 +11,17 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+typedef struct {
+    float   fwd;    /* W */
+    float   ref;
+    float   swr;
+} iio_power_t;
+
 void iio_init();
 
 void iio_set_vref(uint16_t data);
+
+void iio_power_restart();
+
+/* Latest power, true when it is newer than seq */
+bool iio_get_power(iio_power_t *power, uint32_t *seq);
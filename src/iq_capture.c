@@ -0,0 +1,207 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/time.h>
+
+#include "lvgl/lvgl.h"
+#include "iq_capture.h"
+#include "iq_file.h"
+#include "ring.h"
+#include "util.h"
+#include "msg.h"
+#include "recorder.h"
+#include "bands/bands.h"
+#include "settings/op_work.h"
+#include "fpga/adc.h"
+#include "fpga/control.h"
+
+#define RING_SIZE   (512 * 1024)    /* About 4 s of IQ */
+#define WRITER_MS   50
+
+static atomic_bool          on = false;
+static FILE                 *file = NULL;
+static pthread_mutex_t      file_mux;
+
+static ring_t               *ring;
+static uint64_t             start_time;
+static atomic_uint_fast64_t frames;
+static atomic_uint_fast64_t dropped;
+
+static bool create_file() {
+    char        filename[64];
+    time_t      now = time(NULL);
+    struct tm   *t = localtime(&now);
+
+    snprintf(filename, sizeof(filename),
+        "%s/IQ_%04i%02i%02i_%02i%02i%02i.iq",
+        recorder_path, t->tm_year + 1900, t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec
+    );
+
+    file = fopen(filename, "wb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    iq_file_header_t    header;
+    struct timeval      tv;
+
+    gettimeofday(&tv, NULL);
+    memset(&header, 0, sizeof(header));
+
+    header.magic = IQ_FILE_MAGIC;
+    header.version = IQ_FILE_VERSION;
+    header.header_size = sizeof(header);
+    header.rate = ADC_RATE;
+    header.freq = op_work->rx;
+    header.start = (int64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+
+    if (band_settings && band_settings->label) {
+        strncpy(header.band, band_settings->label, sizeof(header.band) - 1);
+    }
+
+    fwrite(&header, sizeof(header), 1, file);
+
+    return true;
+}
+
+/* Writer thread or stop, under file_mux. Straight from the ring memory to stdio */
+
+static void write_ring() {
+    void    *data;
+    size_t  len;
+
+    while ((len = ring_read_ptr(ring, &data)) > 0) {
+        fwrite(data, 1, len, file);
+        ring_release(ring, len);
+    }
+}
+
+static void * writer_thread(void *arg) {
+    while (true) {
+        usleep(WRITER_MS * 1000);
+
+        pthread_mutex_lock(&file_mux);
+
+        if (file) {
+            write_ring();
+        }
+
+        pthread_mutex_unlock(&file_mux);
+    }
+}
+
+void iq_capture_init() {
+    pthread_mutex_init(&file_mux, NULL);
+
+    ring = ring_create(RING_SIZE);
+    atomic_init(&frames, 0);
+    atomic_init(&dropped, 0);
+
+    if (!ring) {
+        LV_LOG_ERROR("Unable to allocate IQ capture ring");
+        return;
+    }
+
+    pthread_t thread;
+
+    pthread_create(&thread, NULL, writer_thread, NULL);
+    pthread_detach(thread);
+}
+
+void iq_capture_set_on(bool x) {
+    if (x) {
+        pthread_mutex_lock(&file_mux);
+
+        if (!ring || !create_file()) {
+            pthread_mutex_unlock(&file_mux);
+            msg_set_text_fmt("Problem with create file");
+            return;
+        }
+
+        ring_clear(ring);
+        start_time = get_time_us();
+        atomic_store(&frames, 0);
+        atomic_store(&dropped, 0);
+
+        pthread_mutex_unlock(&file_mux);
+
+        atomic_store(&on, true);
+        msg_set_text_fmt("IQ capture is on");
+    } else {
+        atomic_store(&on, false);
+        msg_set_text_fmt("IQ capture is off");
+
+        pthread_mutex_lock(&file_mux);
+
+        if (file) {
+            write_ring();
+            fclose(file);
+            file = NULL;
+        }
+
+        pthread_mutex_unlock(&file_mux);
+
+        iq_capture_stats_t stats;
+
+        iq_capture_get_stats(&stats);
+
+        if (stats.dropped) {
+            LV_LOG_WARN("IQ dropped %llu of %llu frames, ring high water %zu of %zu",
+                (unsigned long long) stats.dropped, (unsigned long long) stats.frames, stats.high_water, stats.capacity);
+        } else {
+            LV_LOG_INFO("IQ %llu frames, ring high water %zu of %zu",
+                (unsigned long long) stats.frames, stats.high_water, stats.capacity);
+        }
+    }
+}
+
+bool iq_capture_is_on() {
+    return atomic_load(&on);
+}
+
+/* From the ADC thread. Only a ring copy here, the file I/O is on the writer thread */
+
+void iq_capture_put(const float complex *data, size_t samples) {
+    if (!atomic_load(&on)) {
+        return;
+    }
+
+    iq_frame_t  frame = {
+        .samples = samples,
+        .time = get_time_us() - start_time,
+        .freq = control_get_rx_freq()
+    };
+
+    size_t size = samples * sizeof(float complex);
+
+    /* Single producer: free space can only grow between these calls */
+
+    if (ring_free(ring) < sizeof(frame) + size) {
+        atomic_fetch_add(&dropped, 1);
+        return;
+    }
+
+    ring_write(ring, &frame, sizeof(frame));
+    ring_write(ring, data, size);
+    atomic_fetch_add(&frames, 1);
+}
+
+void iq_capture_get_stats(iq_capture_stats_t *stats) {
+    stats->frames = atomic_load(&frames);
+    stats->dropped = atomic_load(&dropped);
+    stats->high_water = ring ? ring_high_water(ring) : 0;
+    stats->capacity = ring ? ring->size : 0;
+}
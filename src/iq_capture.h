@@ -0,0 +1,28 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <complex.h>
+
+typedef struct {
+    uint64_t    frames;
+    uint64_t    dropped;        /* Frames lost on a full ring */
+    size_t      high_water;     /* Bytes */
+    size_t      capacity;       /* Bytes */
+} iq_capture_stats_t;
+
+void iq_capture_init();
+
+void iq_capture_set_on(bool on);
+bool iq_capture_is_on();
+void iq_capture_put(const float complex *data, size_t samples);
+void iq_capture_get_stats(iq_capture_stats_t *stats);
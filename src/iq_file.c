@@ -0,0 +1,97 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lvgl/lvgl.h"
+#include "iq_file.h"
+#include "fpga/adc.h"
+
+#define FRAME_MAX   (1024 * 1024)   /* Samples, anything bigger is garbage */
+
+iq_reader_t * iq_reader_open(const char *path) {
+    FILE *file = fopen(path, "rb");
+
+    if (!file) {
+        LV_LOG_ERROR("Can not open %s", path);
+        return NULL;
+    }
+
+    iq_reader_t *reader = calloc(1, sizeof(iq_reader_t));
+
+    reader->file = file;
+
+    if (fread(&reader->header, sizeof(reader->header), 1, file) == 1 && reader->header.magic == IQ_FILE_MAGIC) {
+        long skip = (long) reader->header.header_size - sizeof(reader->header);
+
+        if (skip > 0) {
+            fseek(file, skip, SEEK_CUR);
+        }
+
+        if (reader->header.rate != ADC_RATE) {
+            LV_LOG_WARN("%s has rate %u, playing at %u", path, reader->header.rate, ADC_RATE);
+        }
+    } else {
+        /* Headerless, a pipe just loses what was read */
+
+        memset(&reader->header, 0, sizeof(reader->header));
+        reader->header.rate = ADC_RATE;
+        reader->raw = true;
+
+        if (fseek(file, 0, SEEK_SET) != 0) {
+            LV_LOG_WARN("%s is not seekable, skipping the first samples", path);
+        }
+    }
+
+    reader->data_start = ftell(file);
+
+    return reader;
+}
+
+void iq_reader_close(iq_reader_t *reader) {
+    fclose(reader->file);
+    free(reader);
+}
+
+/* Up to samples, 0 at the end or on a broken frame */
+
+size_t iq_reader_read(iq_reader_t *reader, float complex *data, size_t samples) {
+    if (reader->raw) {
+        return fread(data, sizeof(float complex), samples, reader->file);
+    }
+
+    if (reader->frame_left == 0) {
+        if (fread(&reader->frame, sizeof(reader->frame), 1, reader->file) != 1) {
+            return 0;
+        }
+
+        if (reader->frame.samples > FRAME_MAX) {
+            LV_LOG_ERROR("Broken IQ frame of %u samples", reader->frame.samples);
+            return 0;
+        }
+
+        reader->frame_left = reader->frame.samples;
+    }
+
+    if (samples > reader->frame_left) {
+        samples = reader->frame_left;
+    }
+
+    size_t res = fread(data, sizeof(float complex), samples, reader->file);
+
+    reader->frame_left -= res;
+
+    return res;
+}
+
+bool iq_reader_rewind(iq_reader_t *reader) {
+    reader->frame_left = 0;
+
+    return reader->data_start >= 0 && fseek(reader->file, reader->data_start, SEEK_SET) == 0;
+}
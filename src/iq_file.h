@@ -0,0 +1,57 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <complex.h>
+
+/*
+ * Raw IQ stream file: one header, then frames of an iq_frame_t followed by
+ * samples float complex values. Little endian, as written by the radio
+ */
+
+#define IQ_FILE_MAGIC       0x51495342  /* "BSIQ" */
+#define IQ_FILE_VERSION     1
+
+typedef struct {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    header_size;
+    uint32_t    rate;
+    uint32_t    reserved;
+    uint64_t    freq;           /* RX frequency at the start, Hz */
+    int64_t     start;          /* Unix time, us */
+    char        band[16];
+} iq_file_header_t;
+
+typedef struct {
+    uint32_t    samples;
+    uint32_t    reserved;
+    uint64_t    time;           /* Since the start, us */
+    uint64_t    freq;           /* RX frequency, Hz */
+} iq_frame_t;
+
+/* Reader for the above, or for headerless float complex at ADC_RATE */
+
+typedef struct {
+    FILE                *file;
+    iq_file_header_t    header;
+    bool                raw;
+    long                data_start;
+    uint32_t            frame_left;     /* Samples */
+    iq_frame_t          frame;
+} iq_reader_t;
+
+iq_reader_t * iq_reader_open(const char *path);
+void iq_reader_close(iq_reader_t *reader);
+size_t iq_reader_read(iq_reader_t *reader, float complex *data, size_t samples);
+bool iq_reader_rewind(iq_reader_t *reader);
@@ -0,0 +1,115 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "lvgl/lvgl.h"
+#include "iq_play.h"
+#include "iq_file.h"
+#include "util.h"
+#include "msg.h"
+#include "settings/options.h"
+#include "fpga/adc.h"
+
+static atomic_bool      on = false;
+static iq_reader_t      *reader = NULL;
+static pthread_mutex_t  reader_mux;
+static uint64_t         play_time;
+
+void iq_play_init() {
+    pthread_mutex_init(&reader_mux, NULL);
+}
+
+bool iq_play_start(const char *path) {
+    iq_play_stop();
+
+    pthread_mutex_lock(&reader_mux);
+    reader = iq_reader_open(path);
+    play_time = 0;
+    pthread_mutex_unlock(&reader_mux);
+
+    if (!reader) {
+        msg_set_text_fmt("Problem with IQ file");
+        return false;
+    }
+
+    atomic_store(&on, true);
+
+    return true;
+}
+
+void iq_play_stop() {
+    atomic_store(&on, false);
+
+    pthread_mutex_lock(&reader_mux);
+
+    if (reader) {
+        iq_reader_close(reader);
+        reader = NULL;
+    }
+
+    pthread_mutex_unlock(&reader_mux);
+}
+
+bool iq_play_is_on() {
+    return atomic_load(&on);
+}
+
+/* Sleep until the file time catches up with the wall clock, speed times faster */
+
+static void pace(size_t samples) {
+    uint8_t     speed = options->iq.speed ? options->iq.speed : 1;
+    uint64_t    now = get_time_us();
+
+    if (play_time == 0 || now > play_time + 1000000) {
+        play_time = now;
+    }
+
+    play_time += (uint64_t) samples * 1000000 / (ADC_RATE * speed);
+
+    if (play_time > now) {
+        usleep(play_time - now);
+    }
+}
+
+int iq_play_read(float complex *data, size_t size) {
+    size_t res = 0;
+
+    /* The ADC block size keeps the timing the same as live */
+
+    if (size > ADC_SAMPLES) {
+        size = ADC_SAMPLES;
+    }
+
+    pthread_mutex_lock(&reader_mux);
+
+    if (reader) {
+        res = iq_reader_read(reader, data, size);
+
+        if (res == 0 && options->iq.loop && iq_reader_rewind(reader)) {
+            res = iq_reader_read(reader, data, size);
+        }
+
+        if (res == 0) {
+            iq_reader_close(reader);
+            reader = NULL;
+            atomic_store(&on, false);
+            msg_set_text_fmt("IQ playback is over");
+        }
+    }
+
+    pthread_mutex_unlock(&reader_mux);
+
+    if (res > 0 && !options->iq.fast) {
+        pace(res);
+    }
+
+    return res * sizeof(float complex);
+}
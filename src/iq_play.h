@@ -0,0 +1,22 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <complex.h>
+
+void iq_play_init();
+
+bool iq_play_start(const char *path);
+void iq_play_stop();
+bool iq_play_is_on();
+
+/* From the ADC thread instead of the front-end, like read() */
+int iq_play_read(float complex *data, size_t size);
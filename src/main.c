@@ -23,6 +23,10 @@
 #include "keypad.h"
 #include "audio.h"
 #include "recorder.h"
+#include "iq_capture.h"
+#include "iq_play.h"
+#include "fft_capture.h"
+#include "fft_play.h"
 #include "cw.h"
 #include "cw_key.h"
 #include "pannel.h"
@@ -31,6 +35,7 @@
 #include "events.h"
 #include "queue.h"
 #include "gps.h"
+#include "fpga/backend.h"
 #include "fpga/adc.h"
 #include "fpga/dac.h"
 #include "fpga/mb.h"
@@ -85,11 +90,16 @@ int main(void) {
 
     lv_init();
     lv_png_init();
+    backend_init();
 
     fbdev_init();
     mic_init();
     audio_init();
     recorder_init();
+    iq_capture_init();
+    iq_play_init();
+    fft_capture_init();
+    fft_play_init();
     queue_init();
     event_init();
     gpio_init();
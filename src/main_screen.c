@@ -45,6 +45,8 @@
 #include "backlight.h"
 #include "buttons.h"
 #include "recorder.h"
+#include "iq_capture.h"
+#include "fft_capture.h"
 #include "voice.h"
 #include "python/python.h"
 #include "msgs.h"
@@ -218,6 +220,14 @@ void main_screen_action(options_action_t action) {
             dsp_change_mute();
             break;
 
+        case ACTION_IQ_CAPTURE:
+            iq_capture_set_on(!iq_capture_is_on());
+            break;
+
+        case ACTION_FFT_CAPTURE:
+            fft_capture_set_on(!fft_capture_is_on());
+            break;
+
         case ACTION_VOICE_MODE:
             voice_change_mode();
             break;
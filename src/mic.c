@@ -22,6 +22,7 @@
 
 #define DECIM   441
 #define INTER   128
+#define BLOCK   256
 
 static bool             on_air = false;
 static firfilt_rrrf     dc_block;
@@ -35,8 +36,7 @@ static float            *filter_taps = NULL;
 static bool             filter_need_update = false;
 static firfilt_rrrf     filter = NULL;
 
-static bool             mic_equalizer_update = true;
-static biquad_t         mic_equalizer[EQUALIZER_NUM];
+static biquad_cascade_t mic_equalizer;
 
 void mic_init() {
     dc_block = firfilt_rrrf_create_dc_blocker(25, 30.0f);
@@ -44,6 +44,9 @@ void mic_init() {
     resamp = rresamp_rrrf_create_default(INTER, DECIM);     /* DAC_RATE <- AUDIO_CAPTURE_RATE */
     out_buf = cbufferf_create(DAC_RATE / 4);
 
+    biquad_cascade_init(&mic_equalizer);
+    mic_update_equalizer();
+
     agc = agc_create(
         AGC_FAST,               /* mode */
         AUDIO_CAPTURE_RATE,     /* sample rate */
@@ -81,7 +84,15 @@ void mic_update_filter() {
 }
 
 void mic_update_equalizer() {
-    mic_equalizer_update = true;
+    biquad_t sections[EQUALIZER_NUM];
+
+    for (int i = 0; i < EQUALIZER_NUM; i++) {
+        const equalizer_item_t *item = &options->audio.mic.eq[i];
+
+        biquad_peak_eq(&sections[i], item->freq, item->q * 0.5f, item->gain, AUDIO_CAPTURE_RATE);
+    }
+
+    biquad_cascade_set(&mic_equalizer, sections, EQUALIZER_NUM);
 }
 
 size_t mic_modulate(float complex *data, size_t max_size, radio_mode_t mode) {
@@ -120,17 +131,9 @@ void mic_put_audio_samples(size_t nsamples, int16_t *samples) {
         filter_need_update = false;
     }
 
-    if (mic_equalizer_update) {
-        for (int i = 0; i < EQUALIZER_NUM; i++) {
-            const equalizer_item_t *item = &options->audio.mic.eq[i];
-
-            biquad_peak_eq(&mic_equalizer[i], item->freq, item->q * 0.5f, item->gain, 44100);
-        }
-
-        mic_equalizer_update = false;
-    }
-
-    float   a, b;
+    float   a;
+    float   block[BLOCK];
+    size_t  count = 0;
     bool    rec_msg = (dialog_msg_voice_get_state() == MSG_VOICE_RECORD);
 
     for (int16_t i = 0; i < nsamples; i++) {
@@ -138,14 +141,15 @@ void mic_put_audio_samples(size_t nsamples, int16_t *samples) {
         firfilt_rrrf_execute(dc_block, &a);
 
         if (on_air || rec_msg) {
-            for (int n = 0; n < EQUALIZER_NUM; n++) {
-                a = biqiad_apply(&mic_equalizer[n], a);
+            block[count++] = a;
+
+            if (count == BLOCK || i == nsamples - 1) {
+                biquad_cascade_apply(&mic_equalizer, block, count);
+                firfilt_rrrf_execute_block(filter, block, count, block);
+                agc_apply_block(agc, block, block, count);
+                cbufferf_write(in_buf, block, count);
+                count = 0;
             }
-
-            firfilt_rrrf_execute_one(filter, a, &b);
-            b = agc_apply(agc, b);
-
-            cbufferf_push(in_buf, b);
         }
     }
 
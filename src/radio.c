@@ -26,6 +26,7 @@
 #include "dialog_swrscan.h"
 #include "voice.h"
 #include "fpga/control.h"
+#include "fpga/dac.h"
 #include "msg.h"
 #include "msgs.h"
 #include "bands/bands.h"
@@ -38,12 +39,27 @@
 #include "hw/iio.h"
 
 #define FLOW_RESTART_TIMOUT     300
+#define TUNE_PERIOD             (1000 / 30)
+#define POWER_PERIOD            (1000 / 20)
+#define TUNE_STATS_PERIOD       10000
+
+#define TUNE_RX                 (1 << 0)
+#define TUNE_TX                 (1 << 1)
+#define TUNE_FFT                (1 << 2)
 
 static lv_obj_t                 *main_obj;
 
 static radio_state_t            state = RADIO_RX;
 static tx_band_item_t           *current_tx_band = NULL;
 
+static uint8_t                  tune_pending = 0;
+static uint64_t                 tune_start;
+static uint32_t                 tune_shift;
+static uint64_t                 tune_rx;
+static uint64_t                 tune_tx;
+static uint64_t                 tune_fft;
+static radio_tune_stats_t       tune_stats;
+
 bool check_freq(uint64_t freq, uint32_t *shift, int32_t *corr);
 
 bool radio_tick() {
@@ -184,6 +200,111 @@ void radio_rf_route() {
     }
 }
 
+/*
+ * Tuning only updates op_work and the UI. The hardware follows once per UI
+ * frame from tune_timer_cb, so a fast encoder costs one register and GPIO
+ * update per frame instead of one per step
+ */
+
+static void tune_mark(uint8_t what) {
+    if (!tune_pending) {
+        tune_start = get_time_us();
+    }
+
+    tune_pending |= what;
+    tune_stats.updates++;
+}
+
+void radio_tune_commit() {
+    if (!tune_pending) {
+        return;
+    }
+
+    xvrt_update(tune_shift);
+
+    if (tune_pending & TUNE_RX) {
+        control_set_rx_freq(tune_rx);
+        radio_rf_route();
+        radio_load_bpf();
+    }
+
+    if (tune_pending & TUNE_TX) {
+        control_set_tx_freq(tune_tx);
+        radio_load_lpf();
+        radio_load_atu();
+    }
+
+    if (tune_pending & TUNE_FFT) {
+        control_set_fft_freq(tune_fft);
+    }
+
+    uint32_t latency = get_time_us() - tune_start;
+
+    tune_stats.commits++;
+    tune_stats.latency_last = latency;
+
+    if (latency > tune_stats.latency_max) {
+        tune_stats.latency_max = latency;
+    }
+
+    tune_pending = 0;
+}
+
+static void tune_timer_cb(lv_timer_t *t) {
+    radio_tune_commit();
+}
+
+static void power_timer_cb(lv_timer_t *t) {
+    static uint32_t seq = 0;
+    iio_power_t     power;
+
+    if (!iio_get_power(&power, &seq)) {
+        return;
+    }
+
+    switch (state) {
+        case RADIO_TX:
+            tx_info_update(power.fwd, power.swr, NAN);
+            break;
+
+        case RADIO_SWRSCAN:
+            dialog_swrscan_update(power.swr);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void radio_get_tune_stats(radio_tune_stats_t *stats) {
+    control_stats_t control;
+
+    control_get_stats(&control);
+
+    *stats = tune_stats;
+    stats->dds_writes = control.dds_writes;
+    stats->dds_skipped = control.dds_skipped;
+}
+
+/* Logged while tuning goes on */
+
+static void tune_stats_timer_cb(lv_timer_t *t) {
+    static uint64_t     commits = 0;
+    radio_tune_stats_t  stats;
+
+    radio_get_tune_stats(&stats);
+
+    if (stats.commits == commits) {
+        return;
+    }
+
+    commits = stats.commits;
+
+    LV_LOG_INFO("Tune %llu changes, %llu hardware updates, latency %u us (max %u), DDS %llu written %llu skipped",
+        (unsigned long long) stats.updates, (unsigned long long) stats.commits, stats.latency_last, stats.latency_max,
+        (unsigned long long) stats.dds_writes, (unsigned long long) stats.dds_skipped);
+}
+
 void radio_freq_update() {
     uint32_t    shift;
     int32_t     corr;
@@ -233,6 +354,9 @@ void radio_init(lv_obj_t *obj) {
     radio_freq_update();
     radio_load_atu();
 
+    lv_timer_create(tune_timer_cb, TUNE_PERIOD, NULL);
+    lv_timer_create(power_timer_cb, POWER_PERIOD, NULL);
+    lv_timer_create(tune_stats_timer_cb, TUNE_STATS_PERIOD, NULL);
     lv_msg_subsribe(MSG_PTT, radio_msg_cb, NULL);
 }
 
@@ -249,15 +373,13 @@ void radio_set_freq_rx(uint64_t freq) {
         return;
     }
 
-    xvrt_update(shift);
-
     op_work->shift = shift;
     op_work->corr = corr;
     op_work->rx = freq;
 
-    control_set_rx_freq(freq - shift - corr);
-    radio_rf_route();
-    radio_load_bpf();
+    tune_shift = shift;
+    tune_rx = freq - shift - corr;
+    tune_mark(TUNE_RX);
 
     lv_msg_send(MSG_FREQ_RX_CHANGED, &op_work->rx);
 }
@@ -271,15 +393,13 @@ void radio_set_freq_tx(uint64_t freq) {
         return;
     }
 
-    xvrt_update(shift);
-
     op_work->shift = shift;
     op_work->corr = corr;
     op_work->tx = freq;
 
-    control_set_tx_freq(freq - shift - corr);
-    radio_load_lpf();
-    radio_load_atu();
+    tune_shift = shift;
+    tune_tx = freq - shift - corr;
+    tune_mark(TUNE_TX);
 
     lv_msg_send(MSG_FREQ_TX_CHANGED, &op_work->tx);
 }
@@ -315,7 +435,9 @@ uint64_t radio_set_freqs(uint64_t rx, uint64_t tx) {
 void radio_set_freq_fft(uint64_t freq) {
     op_work->fft = freq;
 
-    control_set_fft_freq(freq - op_work->shift - op_work->corr);
+    tune_fft = freq - op_work->shift - op_work->corr;
+    tune_mark(TUNE_FFT);
+
     lv_msg_send(MSG_FREQ_FFT_CHANGED, &op_work->fft);
 }
 
@@ -518,6 +640,7 @@ uint32_t radio_change_filter_transition(int32_t df) {
 void radio_start_atu() {
     if (state == RADIO_RX) {
         state = RADIO_ATU_START;
+        dac_wake();
     }
 }
 
@@ -527,6 +650,8 @@ bool radio_start_swrscan() {
     }
 
     state = RADIO_SWRSCAN;
+    dac_wake();
+
     return true;
 }
 
@@ -576,6 +701,8 @@ void radio_poweroff() {
 
 void radio_set_ptt(bool on) {
     if (on) {
+        radio_tune_commit();
+
         if (current_tx_band) {
             iio_set_vref(current_tx_band->vref);
         }
@@ -585,6 +712,7 @@ void radio_set_ptt(bool on) {
         gpio_set_tx(true);
 
         state = RADIO_TX;
+        dac_ptt();
         lv_msg_send(MSG_TX, NULL);
     } else {
         gpio_set_preamp(true);
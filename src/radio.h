@@ -66,6 +66,15 @@ typedef enum {
     SPLIT_TX
 } split_mode_t;
 
+typedef struct {
+    uint64_t    updates;        /* Frequency changes asked for */
+    uint64_t    commits;        /* Hardware updates done for them */
+    uint32_t    latency_last;   /* us, first change to register write */
+    uint32_t    latency_max;
+    uint64_t    dds_writes;
+    uint64_t    dds_skipped;
+} radio_tune_stats_t;
+
 void radio_init(lv_obj_t *obj);
 bool radio_tick();
 radio_state_t radio_get_state();
@@ -74,6 +83,8 @@ void radio_set_freq_rx(uint64_t freq);
 void radio_set_freq_tx(uint64_t freq);
 uint64_t radio_set_freqs(uint64_t rx, uint64_t tx);
 void radio_set_freq_fft(uint64_t freq);
+void radio_tune_commit();
+void radio_get_tune_stats(radio_tune_stats_t *stats);
 split_mode_t radio_change_split(int16_t d);
 
 void radio_change_mode(radio_change_mode_t select);
@@ -6,13 +6,18 @@
  *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
  */
 
+#include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <sys/time.h>
 #include <sndfile.h>
 
 #include "audio.h"
 #include "dialog_recorder.h"
 #include "recorder.h"
+#include "ring.h"
 #include "msg.h"
 #include "msgs.h"
 #include "settings/options.h"
@@ -21,14 +26,22 @@
 #define DECIM       128
 #define INTER       441
 
+#define RING_SEC    4           /* Absorbs storage stalls */
+#define WRITE_BLOCK 32          /* Resampler outputs per sf_write_float() */
+#define WRITER_MS   50
+
 char                        *recorder_path = "/mnt/rec";
 
 static bool                 on = false;
 static SNDFILE              *file = NULL;
+static pthread_mutex_t      file_mux;
+
+static ring_t               *ring;
+static atomic_uint_fast64_t dropped;
 
-static cbufferf             in_buf;
 static rresamp_rrrf         resamp;
-static float                resamp_buf[INTER];
+static float                *out_buf;
+static size_t               out_count = 0;
 
 static bool create_file() {
     SF_INFO sfinfo;
@@ -75,24 +88,107 @@ static bool create_file() {
     return true;
 }
 
+/* Writer thread or stop, under file_mux */
+
+static void write_ring() {
+    float in_buf[DECIM];
+
+    while (ring_used(ring) >= sizeof(in_buf)) {
+        ring_read(ring, in_buf, sizeof(in_buf));
+        rresamp_rrrf_execute(resamp, in_buf, out_buf + out_count);
+        out_count += INTER;
+
+        if (out_count == INTER * WRITE_BLOCK) {
+            sf_write_float(file, out_buf, out_count);
+            out_count = 0;
+        }
+    }
+}
+
+static void * writer_thread(void *arg) {
+    while (true) {
+        usleep(WRITER_MS * 1000);
+
+        pthread_mutex_lock(&file_mux);
+
+        if (file) {
+            write_ring();
+        }
+
+        pthread_mutex_unlock(&file_mux);
+    }
+}
+
 void recorder_init() {
+    pthread_mutex_init(&file_mux, NULL);
+
     resamp = rresamp_rrrf_create_default(INTER, DECIM);     /* AUDIO_PLAY_RATE <- ADC_RATE */
-    in_buf = cbufferf_create(ADC_RATE / 4);
+    ring = ring_create(ADC_RATE * RING_SEC * sizeof(float));
+    atomic_init(&dropped, 0);
+
+    if (!ring) {
+        LV_LOG_ERROR("Unable to allocate recorder ring");
+        return;
+    }
+
+    if (posix_memalign((void **) &out_buf, 64, INTER * WRITE_BLOCK * sizeof(float)) != 0) {
+        LV_LOG_ERROR("Unable to allocate recorder buffer");
+        return;
+    }
+
+    pthread_t thread;
+
+    pthread_create(&thread, NULL, writer_thread, NULL);
+    pthread_detach(thread);
 }
 
 void recorder_set_on(bool x) {
     if (x) {
-        if (!create_file()) {
+        pthread_mutex_lock(&file_mux);
+
+        if (!ring || !create_file()) {
+            pthread_mutex_unlock(&file_mux);
             msg_set_text_fmt("Problem with create file");
             return;
         } else {
             msg_set_text_fmt("Recorder is on");
         }
+
+        ring_clear(ring);
+        out_count = 0;
+        atomic_store(&dropped, 0);
+
+        pthread_mutex_unlock(&file_mux);
         on = true;
     } else {
         msg_set_text_fmt("Recorder is off");
         on = false;
-        sf_close(file);
+
+        pthread_mutex_lock(&file_mux);
+
+        if (file) {
+            write_ring();
+
+            if (out_count) {
+                sf_write_float(file, out_buf, out_count);
+                out_count = 0;
+            }
+
+            sf_close(file);
+            file = NULL;
+        }
+
+        pthread_mutex_unlock(&file_mux);
+
+        recorder_stats_t stats;
+
+        recorder_get_stats(&stats);
+
+        if (stats.dropped) {
+            LV_LOG_WARN("Dropped %llu samples, ring high water %zu of %zu", (unsigned long long) stats.dropped, stats.high_water, stats.capacity);
+        } else {
+            LV_LOG_INFO("Ring high water %zu of %zu", stats.high_water, stats.capacity);
+        }
     }
 
     lv_msg_send(MSG_RECORDER, &on);
@@ -103,21 +199,16 @@ bool recorder_is_on() {
     return on;
 }
 
-void recorder_put_audio_samples(float *data, uint16_t samples) {
-    cbufferf_write(in_buf, data, samples);
+/* From the ADC thread. Only a ring copy here, resampling and I/O are on the writer thread */
 
-    if (cbufferf_size(in_buf) < ADC_RATE / 8) {
-        return;
+void recorder_put_audio_samples(float *data, uint16_t samples) {
+    if (!ring_write(ring, data, samples * sizeof(float))) {
+        atomic_fetch_add(&dropped, samples);
     }
+}
 
-    while (cbufferf_size(in_buf) > DECIM) {
-        unsigned int    n;
-        float*          buf;
-
-        cbufferf_read(in_buf, DECIM, &buf, &n);
-        rresamp_rrrf_execute(resamp, buf, resamp_buf);
-        cbufferf_release(in_buf, n);
-
-        sf_write_float(file, resamp_buf, INTER);
-    }
+void recorder_get_stats(recorder_stats_t *stats) {
+    stats->dropped = atomic_load(&dropped);
+    stats->high_water = ring ? ring_high_water(ring) / sizeof(float) : 0;
+    stats->capacity = ring ? ring->size / sizeof(float) : 0;
 }
@@ -10,6 +10,13 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+    uint64_t    dropped;        /* Samples lost on a full ring */
+    size_t      high_water;     /* Samples */
+    size_t      capacity;       /* Samples */
+} recorder_stats_t;
 
 extern char *recorder_path;
 
@@ -18,3 +25,4 @@ void recorder_init();
 void recorder_set_on(bool on);
 bool recorder_is_on();
 void recorder_put_audio_samples(float *data, uint16_t samples);
+void recorder_get_stats(recorder_stats_t *stats);
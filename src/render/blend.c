@@ -9,17 +9,6 @@
 #include "blend.h"
 #include <arm_neon.h>
 
-static inline lv_color_t fast_color_mix(lv_color_t c1, lv_color_t c2, uint8_t mix) {
-    lv_color_t  ret;
-    uint8_t     nmix = 255 - mix;
-
-    ret.ch.red = (c1.ch.red * mix + c2.ch.red * nmix) / 256;
-    ret.ch.green = (c1.ch.green * mix + c2.ch.green * nmix) / 256;
-    ret.ch.blue = (c1.ch.blue * mix + c2.ch.blue * nmix) / 256;
-
-    return ret;
-}
-
 void fill_normal(
     lv_color_t *__restrict__ dest_buf, const lv_area_t *__restrict__ dest_area,
     lv_coord_t dest_stride, lv_color_t color, lv_opa_t opa,
@@ -11,4 +11,18 @@
 #include "lvgl/lvgl.h"
 #include "lvgl/src/draw/sw/lv_draw_sw_blend.h"
 
+/* c1 over c2 by mix of 255, opaque result */
+
+static inline lv_color_t fast_color_mix(lv_color_t c1, lv_color_t c2, uint8_t mix) {
+    lv_color_t  ret;
+    uint8_t     nmix = 255 - mix;
+
+    ret.ch.red = (c1.ch.red * mix + c2.ch.red * nmix) / 256;
+    ret.ch.green = (c1.ch.green * mix + c2.ch.green * nmix) / 256;
+    ret.ch.blue = (c1.ch.blue * mix + c2.ch.blue * nmix) / 256;
+    ret.ch.alpha = 0xFF;
+
+    return ret;
+}
+
 void blend(struct _lv_draw_ctx_t * draw_ctx, const lv_draw_sw_blend_dsc_t * dsc);
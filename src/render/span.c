@@ -0,0 +1,53 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include "span.h"
+#include "blend.h"
+
+bool span_ctx_init(span_ctx_t *ctx, lv_draw_ctx_t *draw_ctx, const lv_area_t *coords) {
+    if (!_lv_area_intersect(&ctx->clip, draw_ctx->clip_area, coords)) {
+        return false;
+    }
+
+    ctx->buf = draw_ctx->buf;
+    ctx->stride = lv_area_get_width(draw_ctx->buf_area);
+    ctx->buf_x1 = draw_ctx->buf_area->x1;
+    ctx->buf_y1 = draw_ctx->buf_area->y1;
+
+    return true;
+}
+
+void span_blend_ver(const span_ctx_t *ctx, lv_coord_t x, lv_coord_t y1, lv_coord_t y2, lv_color_t color, lv_opa_t opa) {
+    if (opa >= LV_OPA_MAX) {
+        span_fill_ver(ctx, x, y1, y2, color);
+        return;
+    }
+
+    if (opa == LV_OPA_TRANSP) return;
+    if (x < ctx->clip.x1 || x > ctx->clip.x2) return;
+    if (y1 < ctx->clip.y1) y1 = ctx->clip.y1;
+    if (y2 > ctx->clip.y2) y2 = ctx->clip.y2;
+    if (y1 > y2) return;
+
+    lv_color_t  *dst = span_px(ctx, x, y1);
+
+    for (lv_coord_t y = y1; y <= y2; y++) {
+        *dst = fast_color_mix(color, *dst, opa);
+        dst += ctx->stride;
+    }
+}
+
+void span_blend_px(const span_ctx_t *ctx, lv_coord_t x, lv_coord_t y, lv_color_t color, lv_opa_t opa) {
+    if (opa == LV_OPA_TRANSP) return;
+    if (x < ctx->clip.x1 || x > ctx->clip.x2) return;
+    if (y < ctx->clip.y1 || y > ctx->clip.y2) return;
+
+    lv_color_t *dst = span_px(ctx, x, y);
+
+    *dst = opa >= LV_OPA_MAX ? color : fast_color_mix(color, *dst, opa);
+}
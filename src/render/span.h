@@ -0,0 +1,50 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include "lvgl/lvgl.h"
+
+/*
+ * Direct writes into the draw buffer for widgets which render thousands of
+ * one pixel wide vertical lines per frame. Masks are not applied
+ */
+
+typedef struct {
+    lv_color_t  *buf;
+    lv_coord_t  stride;
+    lv_coord_t  buf_x1;
+    lv_coord_t  buf_y1;
+    lv_area_t   clip;
+} span_ctx_t;
+
+bool span_ctx_init(span_ctx_t *ctx, lv_draw_ctx_t *draw_ctx, const lv_area_t *coords);
+
+void span_blend_ver(const span_ctx_t *ctx, lv_coord_t x, lv_coord_t y1, lv_coord_t y2, lv_color_t color, lv_opa_t opa);
+void span_blend_px(const span_ctx_t *ctx, lv_coord_t x, lv_coord_t y, lv_color_t color, lv_opa_t opa);
+
+static inline lv_color_t * span_px(const span_ctx_t *ctx, lv_coord_t x, lv_coord_t y) {
+    return ctx->buf + (y - ctx->buf_y1) * ctx->stride + (x - ctx->buf_x1);
+}
+
+/* Fill x, y1..y2 (inclusive) with the color */
+
+static inline void span_fill_ver(const span_ctx_t *ctx, lv_coord_t x, lv_coord_t y1, lv_coord_t y2, lv_color_t color) {
+    if (x < ctx->clip.x1 || x > ctx->clip.x2) return;
+    if (y1 < ctx->clip.y1) y1 = ctx->clip.y1;
+    if (y2 > ctx->clip.y2) y2 = ctx->clip.y2;
+    if (y1 > y2) return;
+
+    lv_color_t  *dst = span_px(ctx, x, y1);
+    lv_coord_t  stride = ctx->stride;
+
+    for (lv_coord_t y = y1; y <= y2; y++) {
+        *dst = color;
+        dst += stride;
+    }
+}
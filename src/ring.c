@@ -0,0 +1,147 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ring.h"
+
+#define ALIGN   64
+
+/* NULL if out of memory */
+
+ring_t * ring_create(size_t size) {
+    ring_t  *ring;
+    size_t  pow2 = ALIGN;
+
+    if (posix_memalign((void **) &ring, ALIGN, sizeof(ring_t)) != 0) {
+        return NULL;
+    }
+
+    while (pow2 < size) {
+        pow2 <<= 1;
+    }
+
+    if (posix_memalign((void **) &ring->buf, ALIGN, pow2) != 0) {
+        free(ring);
+        return NULL;
+    }
+
+    ring->size = pow2;
+    ring->mask = pow2 - 1;
+    ring->high_water = 0;
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+
+    return ring;
+}
+
+void ring_destroy(ring_t *ring) {
+    free(ring->buf);
+    free(ring);
+}
+
+size_t ring_used(ring_t *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    return head - tail;
+}
+
+size_t ring_free(ring_t *ring) {
+    return ring->size - ring_used(ring);
+}
+
+size_t ring_high_water(ring_t *ring) {
+    return ring->high_water;
+}
+
+bool ring_write(ring_t *ring, const void *data, size_t len) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t used = head - tail;
+
+    if (ring->size - used < len) {
+        return false;
+    }
+
+    size_t pos = head & ring->mask;
+    size_t part = ring->size - pos;
+
+    if (part >= len) {
+        memcpy(ring->buf + pos, data, len);
+    } else {
+        memcpy(ring->buf + pos, data, part);
+        memcpy(ring->buf, (const uint8_t *) data + part, len - part);
+    }
+
+    atomic_store_explicit(&ring->head, head + len, memory_order_release);
+
+    if (used + len > ring->high_water) {
+        ring->high_water = used + len;
+    }
+
+    return true;
+}
+
+size_t ring_read(ring_t *ring, void *data, size_t len) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t used = head - tail;
+
+    if (len > used) {
+        len = used;
+    }
+
+    size_t pos = tail & ring->mask;
+    size_t part = ring->size - pos;
+
+    if (part >= len) {
+        memcpy(data, ring->buf + pos, len);
+    } else {
+        memcpy(data, ring->buf + pos, part);
+        memcpy((uint8_t *) data + part, ring->buf, len - part);
+    }
+
+    atomic_store_explicit(&ring->tail, tail + len, memory_order_release);
+
+    return len;
+}
+
+/* Contiguous readable part, without copying. Has to be followed by ring_release() */
+
+size_t ring_read_ptr(ring_t *ring, void **data) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t pos = tail & ring->mask;
+    size_t len = head - tail;
+
+    if (len > ring->size - pos) {
+        len = ring->size - pos;
+    }
+
+    *data = ring->buf + pos;
+
+    return len;
+}
+
+void ring_release(ring_t *ring, size_t len) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    atomic_store_explicit(&ring->tail, tail + len, memory_order_release);
+}
+
+/* Drops everything and resets high water. The producer must be idle */
+
+void ring_clear(ring_t *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    atomic_store_explicit(&ring->tail, head, memory_order_release);
+    ring->high_water = 0;
+}
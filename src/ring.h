@@ -0,0 +1,50 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+
+/*
+ * Lock-free single producer, single consumer byte ring. One thread writes,
+ * one thread reads, nobody waits on a lock. Producer and consumer fields
+ * sit on their own cache lines
+ */
+
+typedef struct {
+    uint8_t         *buf;
+    size_t          size;
+    size_t          mask;
+
+    alignas(64) atomic_size_t   head;
+    size_t                      high_water;
+
+    alignas(64) atomic_size_t   tail;
+} ring_t;
+
+ring_t * ring_create(size_t size);
+void ring_destroy(ring_t *ring);
+
+size_t ring_used(ring_t *ring);
+size_t ring_free(ring_t *ring);
+size_t ring_high_water(ring_t *ring);
+
+/* Producer */
+
+bool ring_write(ring_t *ring, const void *data, size_t len);
+
+/* Consumer */
+
+size_t ring_read(ring_t *ring, void *data, size_t len);
+size_t ring_read_ptr(ring_t *ring, void **data);
+void ring_release(ring_t *ring, size_t len);
+void ring_clear(ring_t *ring);
@@ -66,6 +66,7 @@ static const cyaml_schema_field_t options_emnr_schema[] = {
 static const cyaml_schema_field_t denoise_fields_schema[] = {
     CYAML_FIELD_ENUM("mode",                    CYAML_FLAG_OPTIONAL, denoise_t, mode, denoise_mode_strings, CYAML_ARRAY_LEN(denoise_mode_strings)),
     CYAML_FIELD_BOOL("before_agc",              CYAML_FLAG_OPTIONAL, denoise_t, before_agc),
+    CYAML_FIELD_BOOL("pipeline",                CYAML_FLAG_OPTIONAL, denoise_t, pipeline),
     CYAML_FIELD_MAPPING("nr",                   CYAML_FLAG_OPTIONAL, denoise_t, nr, options_nr_schema),
     CYAML_FIELD_MAPPING("emnr",                 CYAML_FLAG_OPTIONAL, denoise_t, emnr, options_emnr_schema),
     CYAML_FIELD_END
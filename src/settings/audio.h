@@ -65,6 +65,7 @@ typedef struct {
 typedef struct {
     denoise_mode_t      mode;
     bool                before_agc;
+    bool                pipeline;   /* On its own thread, fixed added latency while on */
     options_nr_t        nr;
     options_emnr_t      emnr;
 } denoise_t;
@@ -21,6 +21,8 @@ static const cyaml_schema_field_t band_settings_fields_schema[] = {
     CYAML_FIELD_UINT("stop",            CYAML_FLAG_DEFAULT, band_settings_t, stop),
     CYAML_FIELD_BOOL("tx",              CYAML_FLAG_OPTIONAL, band_settings_t, tx),
     CYAML_FIELD_BOOL("jump",            CYAML_FLAG_OPTIONAL, band_settings_t, jump),
+    CYAML_FIELD_FLOAT("auto_floor",     CYAML_FLAG_OPTIONAL, band_settings_t, auto_floor),
+    CYAML_FIELD_FLOAT("auto_peak",      CYAML_FLAG_OPTIONAL, band_settings_t, auto_peak),
     CYAML_FIELD_END
 };
 
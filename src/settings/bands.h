@@ -18,6 +18,8 @@ typedef struct {
     uint64_t        stop;
     bool            tx;
     bool            jump;
+    float           auto_floor;     /* Percent, 0 for options->spectrum */
+    float           auto_peak;
 } band_settings_t;
 
 typedef struct {
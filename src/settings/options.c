@@ -28,6 +28,8 @@ const cyaml_schema_field_t spectrum_fields_schema[] = {
     CYAML_FIELD_BOOL("peak",            CYAML_FLAG_OPTIONAL, options_spectrum_t, peak),
     CYAML_FIELD_UINT("peak_hold",       CYAML_FLAG_OPTIONAL, options_spectrum_t, peak_hold),
     CYAML_FIELD_FLOAT("peak_speed",     CYAML_FLAG_OPTIONAL, options_spectrum_t, peak_speed),
+    CYAML_FIELD_FLOAT("auto_floor",     CYAML_FLAG_OPTIONAL, options_spectrum_t, auto_floor),
+    CYAML_FIELD_FLOAT("auto_peak",      CYAML_FLAG_OPTIONAL, options_spectrum_t, auto_peak),
     CYAML_FIELD_END
 };
 
@@ -64,6 +66,8 @@ static const cyaml_strval_t action_strings[] = {
     { "step_up",            ACTION_STEP_UP },
     { "step_down",          ACTION_STEP_DOWN },
     { "voice_mode",         ACTION_VOICE_MODE },
+    { "iq_capture",         ACTION_IQ_CAPTURE },
+    { "fft_capture",        ACTION_FFT_CAPTURE },
 
     { "app_rtty",           ACTION_APP_RTTY },
     { "app_ft8",            ACTION_APP_FT8 },
@@ -112,6 +116,11 @@ static const cyaml_strval_t clock_view_strings[] = {
     { "power_always",       CLOCK_POWER_ALWAYS },
 };
 
+static const cyaml_strval_t backend_type_strings[] = {
+    { "hw",                 BACKEND_HW },
+    { "file",               BACKEND_FILE },
+};
+
 #define CONTROL_FLAGS (CYAML_FLAG_OPTIONAL | CYAML_FLAG_STRICT)
 
 const cyaml_schema_field_t control_fields_schema[] = {
@@ -213,6 +222,52 @@ const cyaml_schema_field_t clock_fields_schema[] = {
     CYAML_FIELD_END
 };
 
+const cyaml_schema_field_t thread_fields_schema[] = {
+    CYAML_FIELD_UINT("prio",                    CYAML_FLAG_OPTIONAL, options_thread_t, prio),
+    CYAML_FIELD_UINT("affinity",                CYAML_FLAG_OPTIONAL, options_thread_t, affinity),
+    CYAML_FIELD_END
+};
+
+const cyaml_schema_field_t threads_fields_schema[] = {
+    CYAML_FIELD_MAPPING("adc",                  CYAML_FLAG_OPTIONAL | CYAML_FLAG_FLOW, options_threads_t, adc, thread_fields_schema),
+    CYAML_FIELD_MAPPING("dsp",                  CYAML_FLAG_OPTIONAL | CYAML_FLAG_FLOW, options_threads_t, dsp, thread_fields_schema),
+    CYAML_FIELD_MAPPING("dac",                  CYAML_FLAG_OPTIONAL | CYAML_FLAG_FLOW, options_threads_t, dac, thread_fields_schema),
+    CYAML_FIELD_MAPPING("denoise",              CYAML_FLAG_OPTIONAL | CYAML_FLAG_FLOW, options_threads_t, denoise, thread_fields_schema),
+    CYAML_FIELD_END
+};
+
+const cyaml_schema_field_t dac_fields_schema[] = {
+    CYAML_FIELD_UINT("prefill",                 CYAML_FLAG_OPTIONAL, options_dac_t, prefill),
+    CYAML_FIELD_UINT("batch",                   CYAML_FLAG_OPTIONAL, options_dac_t, batch),
+    CYAML_FIELD_END
+};
+
+const cyaml_schema_field_t iq_fields_schema[] = {
+    CYAML_FIELD_UINT("speed",                   CYAML_FLAG_OPTIONAL, options_iq_t, speed),
+    CYAML_FIELD_BOOL("fast",                    CYAML_FLAG_OPTIONAL, options_iq_t, fast),
+    CYAML_FIELD_BOOL("loop",                    CYAML_FLAG_OPTIONAL, options_iq_t, loop),
+    CYAML_FIELD_UINT("fft_fps",                 CYAML_FLAG_OPTIONAL, options_iq_t, fft_fps),
+    CYAML_FIELD_BOOL("fft_wide",                CYAML_FLAG_OPTIONAL, options_iq_t, fft_wide),
+    CYAML_FIELD_END
+};
+
+const cyaml_schema_field_t iio_fields_schema[] = {
+    CYAML_FIELD_UINT("rate",                    CYAML_FLAG_OPTIONAL, options_iio_t, rate),
+    CYAML_FIELD_UINT("block",                   CYAML_FLAG_OPTIONAL, options_iio_t, block),
+    CYAML_FIELD_FLOAT("pwr_scale",              CYAML_FLAG_OPTIONAL, options_iio_t, pwr_scale),
+    CYAML_FIELD_END
+};
+
+const cyaml_schema_field_t backend_fields_schema[] = {
+    CYAML_FIELD_ENUM("type",                    CYAML_FLAG_OPTIONAL, options_backend_t, type, backend_type_strings, CYAML_ARRAY_LEN(backend_type_strings)),
+    CYAML_FIELD_STRING("iq",                    CYAML_FLAG_OPTIONAL, options_backend_t, iq, 0),
+    CYAML_FIELD_STRING("fft",                   CYAML_FLAG_OPTIONAL, options_backend_t, fft, 0),
+    CYAML_FIELD_UINT("fft_fps",                 CYAML_FLAG_OPTIONAL, options_backend_t, fft_fps),
+    CYAML_FIELD_BOOL("fast",                    CYAML_FLAG_OPTIONAL, options_backend_t, fast),
+    CYAML_FIELD_BOOL("loop",                    CYAML_FLAG_OPTIONAL, options_backend_t, loop),
+    CYAML_FIELD_END
+};
+
 const cyaml_schema_field_t options_fields_schema[] = {
     CYAML_FIELD_MAPPING("operator",     CYAML_FLAG_OPTIONAL, options_t, op, operator_fields_schema),
     CYAML_FIELD_MAPPING("audio",        CYAML_FLAG_OPTIONAL, options_t, audio, audio_fields_schema),
@@ -227,6 +282,11 @@ const cyaml_schema_field_t options_fields_schema[] = {
     CYAML_FIELD_MAPPING("voice",        CYAML_FLAG_OPTIONAL, options_t, voice, voice_fields_schema),
     CYAML_FIELD_MAPPING("freq",         CYAML_FLAG_OPTIONAL, options_t, freq, freq_fields_schema),
     CYAML_FIELD_MAPPING("clock",        CYAML_FLAG_OPTIONAL, options_t, clock, clock_fields_schema),
+    CYAML_FIELD_MAPPING("threads",      CYAML_FLAG_OPTIONAL, options_t, threads, threads_fields_schema),
+    CYAML_FIELD_MAPPING("dac",          CYAML_FLAG_OPTIONAL, options_t, dac, dac_fields_schema),
+    CYAML_FIELD_MAPPING("iq",           CYAML_FLAG_OPTIONAL, options_t, iq, iq_fields_schema),
+    CYAML_FIELD_MAPPING("iio",          CYAML_FLAG_OPTIONAL, options_t, iio, iio_fields_schema),
+    CYAML_FIELD_MAPPING("backend",      CYAML_FLAG_OPTIONAL, options_t, backend, backend_fields_schema),
     CYAML_FIELD_END
 };
 
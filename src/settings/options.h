@@ -24,6 +24,8 @@ typedef struct {
     bool                peak;
     uint16_t            peak_hold;
     float               peak_speed;
+    float               auto_floor;
+    float               auto_peak;
 } options_spectrum_t;
 
 typedef enum {
@@ -34,6 +36,8 @@ typedef enum {
     ACTION_STEP_UP,
     ACTION_STEP_DOWN,
     ACTION_VOICE_MODE,
+    ACTION_IQ_CAPTURE,
+    ACTION_FFT_CAPTURE,
 
     ACTION_APP_RTTY = 100,
     ACTION_APP_FT8,
@@ -163,6 +167,51 @@ typedef struct {
     uint8_t             tx_timeout;
 } options_clock_t;
 
+typedef struct {
+    uint8_t             prio;       /* SCHED_FIFO priority, 0 for a normal thread */
+    uint8_t             affinity;   /* CPU mask, 0 for any */
+} options_thread_t;
+
+typedef struct {
+    options_thread_t    adc;
+    options_thread_t    dsp;
+    options_thread_t    dac;
+    options_thread_t    denoise;
+} options_threads_t;
+
+typedef struct {
+    uint8_t             prefill;    /* Blocks written at once on PTT */
+    uint8_t             batch;      /* Blocks per write during TX */
+} options_dac_t;
+
+typedef struct {
+    uint8_t             speed;      /* Playback, times real time, 0 for 1 */
+    bool                fast;       /* Playback as fast as the DSP takes it */
+    bool                loop;
+    uint8_t             fft_fps;    /* Panadapter capture, 0 for 4 */
+    bool                fft_wide;   /* uint16 dB instead of uint8 */
+} options_iq_t;
+
+typedef struct {
+    uint16_t            rate;       /* ADS1015 scans per second, 0 for 400 */
+    uint8_t             block;      /* Scans per read and hkeys debounce, 0 for 8 */
+    float               pwr_scale;  /* W per V^2 of the detectors, 0 for 1 */
+} options_iio_t;
+
+typedef enum {
+    BACKEND_HW = 0,
+    BACKEND_FILE
+} backend_type_t;
+
+typedef struct {
+    backend_type_t      type;
+    char                iq[128];    /* IQ capture, or raw float complex at ADC_RATE */
+    char                fft[128];   /* File or pipe of float[FFT_SAMPLES] frames */
+    uint8_t             fft_fps;    /* 0 for 25 */
+    bool                fast;       /* As fast as the DSP takes it instead of real time */
+    bool                loop;       /* Start over at the end of the files */
+} options_backend_t;
+
 typedef struct {
     options_operator_t  op;
     options_audio_t     audio;
@@ -177,6 +226,11 @@ typedef struct {
     options_voice_t     voice;
     options_freq_t      freq;
     options_clock_t     clock;
+    options_threads_t   threads;
+    options_dac_t       dac;
+    options_iq_t        iq;
+    options_iio_t       iio;
+    options_backend_t   backend;
 } options_t;
 
 extern options_t   *options;
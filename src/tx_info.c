@@ -7,6 +7,7 @@
  */
  
 #include <stdio.h>
+#include <math.h>
 
 #include "tx_info.h"
 #include "styles.h"
@@ -208,7 +209,6 @@ lv_obj_t * tx_info_init(lv_obj_t *parent) {
 
 void tx_info_update(float p, float s, float a) {
     pwr = p;
-    alc = alc * 0.9f + (10.0f - a) * 0.1f;
 
     if (s <= max_swr) {
         vswr = s;
@@ -218,6 +218,14 @@ void tx_info_update(float p, float s, float a) {
 
     lv_obj_invalidate(obj);
 
+    /* NAN when there is no ALC reading */
+
+    if (isnan(a)) {
+        return;
+    }
+
+    alc = alc * 0.9f + (10.0f - a) * 0.1f;
+
     if (options->mag.alc) {
         msg_tiny_set_text_fmt("ALC: %.1f", alc);
     }
@@ -15,4 +15,4 @@
 
 lv_obj_t * tx_info_init(lv_obj_t *parent);
 
-void tx_info_update(float pwr, float vswr, float alc);
+void tx_info_update(float pwr, float vswr, float alc);     /* alc NAN for none */
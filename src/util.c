@@ -6,10 +6,15 @@
  *  Copyright (c) 2022-2023 Belousov Oleg aka R1CBU
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/time.h>
 #include <time.h>
+#include <sched.h>
 #include "util.h"
 
 uint64_t get_time() {
@@ -22,6 +27,14 @@ uint64_t get_time() {
     return usec / 1000;
 }
 
+uint64_t get_time_us() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t) now.tv_sec * 1000000L + now.tv_nsec / 1000;
+}
+
 void get_time_str(char *str, size_t str_size) {
     time_t      now = time(NULL);
     struct tm   *t = localtime(&now);
@@ -104,3 +117,29 @@ uint64_t from_bcd(const uint8_t bcd_data[], uint8_t len) {
     
     return data;
 }
+
+bool thread_set_rt(pthread_t thread, uint8_t prio, uint32_t affinity) {
+    bool ok = true;
+
+    if (prio) {
+        struct sched_param param = { .sched_priority = prio };
+
+        ok &= pthread_setschedparam(thread, SCHED_FIFO, &param) == 0;
+    }
+
+    if (affinity) {
+        cpu_set_t set;
+
+        CPU_ZERO(&set);
+
+        for (int i = 0; i < 32; i++) {
+            if (affinity & (1 << i)) {
+                CPU_SET(i, &set);
+            }
+        }
+
+        ok &= pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+    }
+
+    return ok;
+}
@@ -9,8 +9,11 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
 
 uint64_t get_time();
+uint64_t get_time_us();
 void get_time_str(char *str, size_t str_size);
 
 void split_freq(uint64_t freq, uint16_t *mhz, uint16_t *khz, uint16_t *hz);
@@ -22,3 +25,5 @@ void lpf(float *x, float current, float beta);
 
 void to_bcd(uint8_t bcd_data[], uint64_t data, uint8_t len);
 uint64_t from_bcd(const uint8_t bcd_data[], uint8_t len);
+
+bool thread_set_rt(pthread_t thread, uint8_t prio, uint32_t affinity);
@@ -9,7 +9,9 @@
  *********************/
 
 #include <stdlib.h>
+#include <math.h>
 #include "lv_spectrum.h"
+#include "src/render/span.h"
 
 /*********************
  *      DEFINES
@@ -24,6 +26,8 @@ static void lv_spectrum_constructor(const lv_obj_class_t * class_p, lv_obj_t * o
 static void lv_spectrum_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
 static void lv_spectrum_event(const lv_obj_class_t * class_p, lv_event_t * e);
 
+static void draw_column(const span_ctx_t * span, lv_coord_t x, float top, float bottom, lv_color_t color, lv_opa_t opa);
+
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -60,6 +64,7 @@ void lv_spectrum_set_data_size(lv_obj_t * obj, uint16_t size) {
     spectrum->data_size = size;
     spectrum->data_buf = lv_mem_realloc(spectrum->data_buf, size * sizeof(float));
     spectrum->peak_buf = lv_mem_realloc(spectrum->peak_buf, size * sizeof(lv_spectrum_peak_t));
+    spectrum->y_buf = lv_mem_realloc(spectrum->y_buf, size * 2 * sizeof(float));
 }
 
 void lv_spectrum_clear_data(lv_obj_t * obj) {
@@ -231,6 +236,7 @@ static void lv_spectrum_constructor(const lv_obj_class_t * class_p, lv_obj_t * o
     spectrum->data_size = 0;
     spectrum->data_buf = NULL;
     spectrum->peak_buf = NULL;
+    spectrum->y_buf = NULL;
     spectrum->min = -40;
     spectrum->max = 0;
     spectrum->span = 100000;
@@ -245,6 +251,27 @@ static void lv_spectrum_destructor(const lv_obj_class_t * class_p, lv_obj_t * ob
 
     if (spectrum->data_buf) lv_mem_free(spectrum->data_buf);
     if (spectrum->peak_buf) lv_mem_free(spectrum->peak_buf);
+    if (spectrum->y_buf) lv_mem_free(spectrum->y_buf);
+}
+
+/* Vertical span top..bottom (fractional), partly covered end pixels are blended */
+
+static void draw_column(const span_ctx_t * span, lv_coord_t x, float top, float bottom, lv_color_t color, lv_opa_t opa) {
+    lv_coord_t  y1 = floorf(top);
+    lv_coord_t  y2 = floorf(bottom);
+
+    if (y1 == y2) {
+        span_blend_px(span, x, y1, color, opa * (bottom - top));
+        return;
+    }
+
+    span_blend_px(span, x, y1, color, opa * (y1 + 1 - top));
+
+    if (y2 - 1 > y1) {
+        span_blend_ver(span, x, y1 + 1, y2 - 1, color, opa);
+    }
+
+    span_blend_px(span, x, y2, color, opa * (bottom - y2));
 }
 
 static void lv_spectrum_event(const lv_obj_class_t * class_p, lv_event_t * e) {
@@ -260,6 +287,10 @@ static void lv_spectrum_event(const lv_obj_class_t * class_p, lv_event_t * e) {
     if (code == LV_EVENT_DRAW_MAIN_END) {
         lv_spectrum_t   *spectrum = (lv_spectrum_t *) obj;
         lv_draw_ctx_t   *draw_ctx = lv_event_get_draw_ctx(e);
+        span_ctx_t      span;
+
+        if (!spectrum->y_buf) return;
+        if (!span_ctx_init(&span, draw_ctx, &obj->coords)) return;
 
         lv_draw_line_dsc_t  main_line_dsc;
         lv_draw_line_dsc_t  peak_line_dsc;
@@ -280,50 +311,61 @@ static void lv_spectrum_event(const lv_obj_class_t * class_p, lv_event_t * e) {
         lv_coord_t w = lv_obj_get_width(obj);
         lv_coord_t h = lv_obj_get_height(obj);
 
-        lv_point_t main_a, main_b;
-        lv_point_t peak_a, peak_b;
+        /* Heights of all points in one pass */
 
-        if (!spectrum->filled) {
-            main_b.x = x1;
-            main_b.y = y1 + h;
-        }
-
-        peak_b.x = x1;
-        peak_b.y = y1 + h;
-
-        float range = spectrum->max - spectrum->min;
+        const uint16_t  size = spectrum->data_size;
+        float           *main_y = spectrum->y_buf;
+        float           *peak_y = spectrum->y_buf + size;
+        float           bottom = y1 + h;
+        float           k = h / (float) (spectrum->max - spectrum->min);
+        float           min = spectrum->min;
 
-        for (uint16_t i = 0; i < spectrum->data_size; i++) {
-            float       v = (spectrum->data_buf[i] - spectrum->min) / range;
-            int32_t     x = i * w / spectrum->data_size;
+        for (uint16_t i = 0; i < size; i++) {
+            main_y[i] = fminf(fmaxf(bottom - (spectrum->data_buf[i] - min) * k, y1 - 1.0f), bottom);
+        }
 
-            /* Peak */
+        if (spectrum->peak_on) {
+            for (uint16_t i = 0; i < size; i++) {
+                peak_y[i] = fminf(fmaxf(bottom - (spectrum->peak_buf[i].val - min) * k, y1 - 1.0f), bottom);
+            }
+        }
 
-            if (spectrum->peak_on) {
-                float v_peak = (spectrum->peak_buf[i].val - spectrum->min) / range;
+        /* Columns between neighboring points, peak trace under the main one */
 
-                peak_a.x = x1 + x;
-                peak_a.y = y1 + (1.0f - v_peak) * h;
+        float main_half = main_line_dsc.width / 2.0f;
+        float peak_half = spectrum->peak_on ? peak_line_dsc.width / 2.0f : 0.0f;
 
-                lv_draw_line(draw_ctx, &peak_line_dsc, &peak_a, &peak_b);
+        for (uint16_t i = 0; i < size; i++) {
+            lv_coord_t  xa = i * w / size;
+            lv_coord_t  xb = (i + 1) * w / size;
+            uint16_t    next = i + 1 < size ? i + 1 : i;
 
-                peak_b = peak_a;
+            if (xb == xa) {
+                xb = xa + 1;
             }
 
-            /* Main */
+            float   step = 1.0f / (xb - xa);
+            float   main_dy = (main_y[next] - main_y[i]) * step;
+            float   peak_dy = spectrum->peak_on ? (peak_y[next] - peak_y[i]) * step : 0.0f;
 
-            main_a.x = x1 + x;
-            main_a.y = y1 + (1.0f - v) * h;
+            for (lv_coord_t x = xa; x < xb; x++) {
+                float t = x - xa;
 
-            if (spectrum->filled) {
-                main_b.x = main_a.x;
-                main_b.y = y1 + h;
-            }
+                if (spectrum->peak_on) {
+                    float a = peak_y[i] + peak_dy * t;
+                    float b = a + peak_dy;
 
-            lv_draw_line(draw_ctx, &main_line_dsc, &main_a, &main_b);
+                    draw_column(&span, x1 + x, fminf(a, b) - peak_half, fmaxf(a, b) + peak_half, peak_line_dsc.color, peak_line_dsc.opa);
+                }
 
-            if (!spectrum->filled) {
-                main_b = main_a;
+                float a = main_y[i] + main_dy * t;
+                float b = a + main_dy;
+
+                if (spectrum->filled) {
+                    draw_column(&span, x1 + x, fminf(a, b), bottom, main_line_dsc.color, main_line_dsc.opa);
+                } else {
+                    draw_column(&span, x1 + x, fminf(a, b) - main_half, fmaxf(a, b) + main_half, main_line_dsc.color, main_line_dsc.opa);
+                }
             }
         }
     }
@@ -41,6 +41,7 @@ typedef struct {
     uint16_t            data_size;
     float               *data_buf;
     lv_spectrum_peak_t  *peak_buf;
+    float               *y_buf;
 } lv_spectrum_t;
 
 extern const lv_obj_class_t lv_spectrum_class;
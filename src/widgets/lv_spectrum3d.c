@@ -10,6 +10,7 @@
 
 #include <stdlib.h>
 #include "lv_spectrum3d.h"
+#include "src/render/span.h"
 
 /*********************
  *      DEFINES
@@ -24,6 +25,8 @@ static void lv_spectrum3d_constructor(const lv_obj_class_t * class_p, lv_obj_t *
 static void lv_spectrum3d_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
 static void lv_spectrum3d_event(const lv_obj_class_t * class_p, lv_event_t * e);
 
+static void update_shade(lv_spectrum3d_t * spectrum3d);
+
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -75,6 +78,8 @@ void lv_spectrum3d_set_palette_color(lv_obj_t * obj, uint16_t index, float frac,
             for (int i = 0; i < 256; i++) {
                 spectrum3d->palette[i] = lv_gradient_calculate(&spectrum3d->grad, 256, i);
             }
+
+            update_shade(spectrum3d);
         }
     }
 }
@@ -86,11 +91,18 @@ void lv_spectrum3d_set_data_size(lv_obj_t * obj, uint16_t size, uint16_t depth)
 
     spectrum3d->data_size = size;
     spectrum3d->depth = depth;
+    spectrum3d->data_top = 0;
 
     spectrum3d->data_buf = lv_mem_realloc(spectrum3d->data_buf, size * spectrum3d->depth * sizeof(uint8_t));
-    spectrum3d->line_buf = lv_mem_realloc(spectrum3d->line_buf, size * sizeof(uint8_t));
+    spectrum3d->line_offset = lv_mem_realloc(spectrum3d->line_offset, spectrum3d->depth * sizeof(int32_t));
+
+    for (uint16_t d = 0; d < spectrum3d->depth; d++) {
+        spectrum3d->line_offset[d] = spectrum3d->offset;
+    }
 
     spectrum3d->top_buf = lv_mem_realloc(spectrum3d->top_buf, 800 * sizeof(lv_coord_t));
+
+    update_shade(spectrum3d);
 }
 
 void lv_spectrum3d_clear_data(lv_obj_t * obj) {
@@ -100,7 +112,10 @@ void lv_spectrum3d_clear_data(lv_obj_t * obj) {
 
     spectrum3d->scroll_surplus = 0;
     memset(spectrum3d->data_buf, 0, spectrum3d->data_size * spectrum3d->depth * sizeof(uint8_t));
-    memset(spectrum3d->line_buf, 0, spectrum3d->data_size * sizeof(uint8_t));
+
+    for (uint16_t d = 0; d < spectrum3d->depth; d++) {
+        spectrum3d->line_offset[d] = spectrum3d->offset;
+    }
 }
 
 void lv_spectrum3d_scroll_data(lv_obj_t * obj, int32_t df) {
@@ -124,31 +139,10 @@ void lv_spectrum3d_scroll_data(lv_obj_t * obj, int32_t df) {
         spectrum3d->scroll_surplus %= div;
     }
 
-    /* Scroll */
-
-    int16_t px = spectrum3d->scroll;
-
-    if (px) {
-        uint8_t         *ptr = spectrum3d->data_buf;
-        uint32_t        line_len = spectrum3d->data_size;
-        uint8_t         *line_buf = spectrum3d->line_buf;
-        uint16_t        offset = abs(px);
-        uint16_t        tail = (spectrum3d->data_size - abs(px));
-
-        for (int y = 0; y < spectrum3d->depth; y++) {
-            if (px > 0) {
-                memset(line_buf + tail, 0, offset);
-                memcpy(line_buf, ptr + offset, tail);
-                memcpy(ptr, line_buf, line_len);
-            } else {
-                memset(line_buf, 0, offset);
-                memcpy(line_buf + offset, ptr, tail);
-                memcpy(ptr, line_buf, line_len);
-            }
-
-            ptr += line_len;
-        }
+    /* Scroll. Lines keep their offset and are shifted at draw time */
 
+    if (spectrum3d->scroll) {
+        spectrum3d->offset += spectrum3d->scroll;
         spectrum3d->scroll = 0;
     }
 }
@@ -162,20 +156,21 @@ void lv_spectrum3d_add_data(lv_obj_t * obj, float * data, uint16_t cnt) {
         return;
     }
 
-    /* Scroll down */
-
-    uint16_t    data_size = spectrum3d->data_size;
-    uint8_t     *ptr = spectrum3d->data_buf + data_size * spectrum3d->depth - data_size * 2;
+    /* Scroll down: the oldest line becomes the front one */
 
-    for (uint16_t depth = 0; depth < spectrum3d->depth - 1; depth++) {
-        memcpy(ptr + data_size, ptr, data_size);
-        ptr -= data_size;
+    if (spectrum3d->data_top == 0) {
+        spectrum3d->data_top = spectrum3d->depth;
     }
 
+    spectrum3d->data_top--;
+    spectrum3d->line_offset[spectrum3d->data_top] = spectrum3d->offset;
+
     /* Fill */
 
-    float    range = spectrum3d->max - spectrum3d->min;
-    uint16_t shift = 0;
+    uint16_t    data_size = spectrum3d->data_size;
+    uint8_t     *line = spectrum3d->data_buf + spectrum3d->data_top * data_size;
+    float       range = spectrum3d->max - spectrum3d->min;
+    uint16_t    shift = 0;
 
     if (cnt > data_size) {
         shift = (cnt - data_size) / 2;
@@ -193,7 +188,7 @@ void lv_spectrum3d_add_data(lv_obj_t * obj, float * data, uint16_t cnt) {
 
         uint8_t id = v * 255;
 
-        spectrum3d->data_buf[i] = id;
+        line[i] = id;
     }
 }
 
@@ -233,7 +228,8 @@ static void lv_spectrum3d_constructor(const lv_obj_class_t * class_p, lv_obj_t *
 
     spectrum3d->data_size = 0;
     spectrum3d->data_buf = NULL;
-    spectrum3d->line_buf = NULL;
+    spectrum3d->data_top = 0;
+    spectrum3d->line_offset = NULL;
     spectrum3d->top_buf = NULL;
     spectrum3d->depth = 150;
 
@@ -241,8 +237,11 @@ static void lv_spectrum3d_constructor(const lv_obj_class_t * class_p, lv_obj_t *
     spectrum3d->max = 0;
     spectrum3d->span = 100000;
     spectrum3d->scroll_surplus = 0;
+    spectrum3d->scroll = 0;
+    spectrum3d->offset = 0;
 
     spectrum3d->palette = NULL;
+    spectrum3d->shade = NULL;
 
     LV_TRACE_OBJ_CREATE("finished");
 }
@@ -252,8 +251,30 @@ static void lv_spectrum3d_destructor(const lv_obj_class_t * class_p, lv_obj_t *
     lv_spectrum3d_t * spectrum3d = (lv_spectrum3d_t *)obj;
 
     if (spectrum3d->data_buf) lv_mem_free(spectrum3d->data_buf);
-    if (spectrum3d->line_buf) lv_mem_free(spectrum3d->line_buf);
+    if (spectrum3d->line_offset) lv_mem_free(spectrum3d->line_offset);
     if (spectrum3d->top_buf) lv_mem_free(spectrum3d->top_buf);
+    if (spectrum3d->palette) lv_mem_free(spectrum3d->palette);
+    if (spectrum3d->shade) lv_mem_free(spectrum3d->shade);
+}
+
+/* Palette darkened for every depth, so the draw loop is only a lookup */
+
+static void update_shade(lv_spectrum3d_t * spectrum3d) {
+    uint16_t depth = spectrum3d->depth;
+
+    if (!spectrum3d->palette || !spectrum3d->data_buf) {
+        return;
+    }
+
+    spectrum3d->shade = lv_mem_realloc(spectrum3d->shade, depth * 256 * sizeof(lv_color_t));
+
+    for (uint16_t d = 0; d < depth; d++) {
+        lv_color_t *shade = &spectrum3d->shade[d * 256];
+
+        for (int i = 0; i < 256; i++) {
+            shade[i] = lv_color_darken(spectrum3d->palette[i], 192 * d / depth);
+        }
+    }
 }
 
 static void lv_spectrum3d_event(const lv_obj_class_t * class_p, lv_event_t * e) {
@@ -269,15 +290,12 @@ static void lv_spectrum3d_event(const lv_obj_class_t * class_p, lv_event_t * e)
     if (code == LV_EVENT_DRAW_MAIN_END) {
         lv_spectrum3d_t     *spectrum3d = (lv_spectrum3d_t *) obj;
         lv_draw_ctx_t       *draw_ctx = lv_event_get_draw_ctx(e);
-        lv_draw_line_dsc_t  line_dsc;
+        span_ctx_t          span;
 
         if (!spectrum3d->data_buf) return;
         if (!spectrum3d->top_buf) return;
-        if (!spectrum3d->palette) return;
-
-        lv_draw_line_dsc_init(&line_dsc);
-
-        line_dsc.width = 1;
+        if (!spectrum3d->shade) return;
+        if (!span_ctx_init(&span, draw_ctx, &obj->coords)) return;
 
         lv_coord_t x1 = obj->coords.x1;
         lv_coord_t y1 = obj->coords.y1;
@@ -289,46 +307,50 @@ static void lv_spectrum3d_event(const lv_obj_class_t * class_p, lv_event_t * e)
             spectrum3d->top_buf[i] = y1 + h;
         }
 
-        lv_point_t      a, b;
         float           scale = 1.0f;
 
-        const uint8_t   *data = spectrum3d->data_buf;
         const uint16_t  data_size = spectrum3d->data_size;
         const uint16_t  depth = spectrum3d->depth;
 
+        /*
+         * Front to back. A column only gets the part above everything drawn
+         * before it, so each pixel is written once at most
+         */
+
         for (uint16_t d = 0; d < depth; d++) {
             lv_coord_t  y = y1 - d * h / depth;
             lv_coord_t  bottom = y + h;
 
+            if (bottom < span.clip.y1) {
+                break;
+            }
+
+            uint16_t            line = (spectrum3d->data_top + d) % depth;
+            const uint8_t       *data = spectrum3d->data_buf + line * data_size;
+            const lv_color_t    *shade = &spectrum3d->shade[d * 256];
+            int32_t             center = data_size / 2 + spectrum3d->offset - spectrum3d->line_offset[line];
+            float               inv_scale = 1.0f / scale;
+            float               k = scale * 0.25f / 255.0f;
+
             for (lv_coord_t x = 0; x < w; x++) {
-                int32_t     index = data_size / 2 + (x - w / 2) / scale;
+                int32_t     index = center + (int32_t) ((x - w / 2) * inv_scale);
 
-                if (index < 0 || index > data_size) {
+                if (index < 0 || index >= data_size) {
                     continue;
                 }
 
                 uint8_t     id = data[index];
-                float       v = id / 255.0f * scale * 0.25f;
                 lv_coord_t  prev_top = spectrum3d->top_buf[x];
-                lv_coord_t  top = y + (1.0f - v) * h;
+                lv_coord_t  top = y + (1.0f - id * k) * h;
 
-                if (top > prev_top) {
+                if (top >= prev_top) {
                     continue;
                 }
 
-                a.x = x;
-                a.y = top;
-
-                b.x = x;
-                b.y = bottom > prev_top ? prev_top : bottom;
-
-                line_dsc.color = lv_color_darken(spectrum3d->palette[id], 192 * d / depth);
-
-                lv_draw_line(draw_ctx, &line_dsc, &a, &b);
+                span_fill_ver(&span, x1 + x, top, bottom < prev_top ? bottom : prev_top - 1, shade[id]);
                 spectrum3d->top_buf[x] = top;
             }
 
-            data += data_size;
             scale -= 4.0f / w;
         }
     }
@@ -27,17 +27,20 @@ typedef struct {
     uint16_t            depth;
     uint16_t            data_size;
     uint8_t             *data_buf;
-    uint8_t             *line_buf;
+    uint16_t            data_top;
+    int32_t             *line_offset;
     lv_coord_t          *top_buf;
 
     lv_grad_dsc_t       grad;
     lv_color_t          *palette;
+    lv_color_t          *shade;
 
     int16_t             min;
     int16_t             max;
     int32_t             span;
     int16_t             scroll_surplus;
     int32_t             scroll;
+    int32_t             offset;
 } lv_spectrum3d_t;
 
 extern const lv_obj_class_t lv_spectrum3d_class;
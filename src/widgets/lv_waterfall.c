@@ -22,6 +22,7 @@
 
 static void lv_waterfall_constructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
 static void lv_waterfall_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
+static void lv_waterfall_event(const lv_obj_class_t * class_p, lv_event_t * e);
 
 /**********************
  *  STATIC VARIABLES
@@ -30,6 +31,7 @@ static void lv_waterfall_destructor(const lv_obj_class_t * class_p, lv_obj_t * o
 const lv_obj_class_t lv_waterfall_class  = {
     .constructor_cb = lv_waterfall_constructor,
     .destructor_cb = lv_waterfall_destructor,
+    .event_cb = lv_waterfall_event,
     .base_class = &lv_obj_class,
     .instance_size = sizeof(lv_waterfall_t),
 };
@@ -85,17 +87,18 @@ void lv_waterfall_set_data_size(lv_obj_t * obj, uint16_t size) {
     lv_waterfall_t  *waterfall = (lv_waterfall_t *)obj;
     lv_coord_t      height = lv_obj_get_height(obj);
 
+    if (waterfall->dsc) lv_img_buf_free(waterfall->dsc);
+
     waterfall->dsc = lv_img_buf_alloc(size, height, LV_IMG_CF_TRUE_COLOR);
     memset(waterfall->dsc->data, 0, waterfall->dsc->data_size);
 
     waterfall->line_len = waterfall->dsc->data_size / height;
-    waterfall->line_buf = lv_mem_realloc(waterfall->line_buf, waterfall->line_len);
-
-    waterfall->img = lv_img_create(obj);
+    waterfall->line_top = 0;
+    waterfall->line_offset = lv_mem_realloc(waterfall->line_offset, height * sizeof(int32_t));
 
-    lv_obj_align(waterfall->img, LV_ALIGN_CENTER, 0, 0);
-    lv_img_set_src(waterfall->img, waterfall->dsc);
-    lv_img_cache_invalidate_src(waterfall->dsc);
+    for (int y = 0; y < height; y++) {
+        waterfall->line_offset[y] = waterfall->offset;
+    }
 }
 
 void lv_waterfall_set_max(lv_obj_t * obj, int16_t db) {
@@ -125,10 +128,20 @@ void lv_waterfall_set_span(lv_obj_t * obj, int32_t hz) {
 void lv_waterfall_clear_data(lv_obj_t * obj) {
     LV_ASSERT_OBJ(obj, MY_CLASS);
 
-    lv_waterfall_t * waterfall = (lv_waterfall_t *)obj;
+    lv_waterfall_t  *waterfall = (lv_waterfall_t *)obj;
+    lv_img_dsc_t    *dsc = waterfall->dsc;
 
-    memset(waterfall->dsc->data, 0, waterfall->dsc->data_size);
-    lv_img_cache_invalidate_src(waterfall->dsc);
+    if (!dsc) {
+        return;
+    }
+
+    memset(dsc->data, 0, dsc->data_size);
+
+    for (uint16_t y = 0; y < dsc->header.h; y++) {
+        waterfall->line_offset[y] = waterfall->offset;
+    }
+
+    lv_obj_invalidate(obj);
 }
 
 int32_t lv_waterfall_scroll_data(lv_obj_t * obj, int32_t df) {
@@ -136,7 +149,7 @@ int32_t lv_waterfall_scroll_data(lv_obj_t * obj, int32_t df) {
 
     lv_waterfall_t * waterfall = (lv_waterfall_t *)obj;
 
-    uint16_t    div = waterfall->span / lv_obj_get_width(waterfall);
+    uint16_t    div = waterfall->span / lv_obj_get_width(obj);
     int16_t     surplus = df % div;
 
     waterfall->scroll += df / div;
@@ -152,32 +165,12 @@ int32_t lv_waterfall_scroll_data(lv_obj_t * obj, int32_t df) {
         waterfall->scroll_surplus %= div;
     }
 
-    /* Scroll */
+    /* Scroll. Lines are not touched here, each one is shifted at draw time */
 
     int16_t px = waterfall->scroll;
 
     if (px) {
-        lv_img_dsc_t    *dsc = waterfall->dsc;
-        uint8_t         *ptr = dsc->data;
-        uint32_t        line_len = waterfall->line_len;
-        uint8_t         *line_buf = waterfall->line_buf;
-        uint16_t        offset = abs(px) * 4;
-        uint16_t        tail = (dsc->header.w - abs(px)) * 4;
-
-        for (int y = 0; y < dsc->header.h; y++) {
-            if (px > 0) {
-                memset(line_buf + tail, 0, offset);
-                memcpy(line_buf, ptr + offset, tail);
-                memcpy(ptr, line_buf, line_len);
-            } else {
-                memset(line_buf, 0, offset);
-                memcpy(line_buf + offset, ptr, tail);
-                memcpy(ptr, line_buf, line_len);
-            }
-
-            ptr += line_len;
-        }
-
+        waterfall->offset += px;
         waterfall->scroll = 0;
     }
 
@@ -194,22 +187,24 @@ void lv_waterfall_add_data(lv_obj_t * obj, float * data, uint16_t cnt) {
         return;
     }
 
-    uint32_t    line_len = waterfall->line_len;
-    uint8_t     *ptr = dsc->data + dsc->data_size - line_len * 2;
-
-    /* Scroll down */
+    /* Scroll down: the oldest line becomes the new top one */
 
-    for (uint16_t y = 0; y < dsc->header.h - 1; y++) {
-        memcpy(ptr + line_len, ptr, line_len);
-        ptr -= line_len;
+    if (waterfall->line_top == 0) {
+        waterfall->line_top = dsc->header.h;
     }
 
+    waterfall->line_top--;
+    waterfall->line_offset[waterfall->line_top] = waterfall->offset;
+
     /* Paint */
 
+    lv_color_t  *line = (lv_color_t *) (dsc->data + waterfall->line_top * waterfall->line_len);
+    float       min = waterfall->min;
+    float       k = 1.0f / (waterfall->max - waterfall->min);
+
     for (uint32_t x = 0; x < dsc->header.w; x++) {
         uint32_t    index = x * cnt / dsc->header.w;
-        float       d = data[index];
-        float       v = (d - waterfall->min) / (waterfall->max - waterfall->min);
+        float       v = (data[index] - min) * k;
 
         if (v < 0.0f) {
             v = 0.0f;
@@ -219,8 +214,10 @@ void lv_waterfall_add_data(lv_obj_t * obj, float * data, uint16_t cnt) {
 
         uint8_t id = v * 255;
 
-        lv_img_buf_set_px_color(dsc, x, 0, waterfall->palette[id]);
+        line[x] = waterfall->palette[id];
     }
+
+    lv_obj_invalidate(obj);
 }
 
 /**********************
@@ -233,15 +230,17 @@ static void lv_waterfall_constructor(const lv_obj_class_t * class_p, lv_obj_t *
 
     lv_waterfall_t * waterfall = (lv_waterfall_t *)obj;
 
-    waterfall->img = NULL;
+    waterfall->dsc = NULL;
     waterfall->palette = NULL;
     waterfall->line_len = 0;
-    waterfall->line_buf = NULL;
+    waterfall->line_top = 0;
+    waterfall->line_offset = NULL;
     waterfall->min = -40;
     waterfall->max = 0;
     waterfall->span = 100000;
     waterfall->scroll_surplus = 0;
     waterfall->scroll = 0;
+    waterfall->offset = 0;
 
     LV_TRACE_OBJ_CREATE("finished");
 }
@@ -251,5 +250,75 @@ static void lv_waterfall_destructor(const lv_obj_class_t * class_p, lv_obj_t * o
     lv_waterfall_t * waterfall = (lv_waterfall_t *)obj;
 
     if (waterfall->palette) lv_mem_free(waterfall->palette);
-    if (waterfall->line_buf) lv_mem_free(waterfall->line_buf);
+    if (waterfall->line_offset) lv_mem_free(waterfall->line_offset);
+    if (waterfall->dsc) lv_img_buf_free(waterfall->dsc);
+}
+
+static void lv_waterfall_event(const lv_obj_class_t * class_p, lv_event_t * e) {
+    LV_UNUSED(class_p);
+
+    lv_res_t res = lv_obj_event_base(MY_CLASS, e);
+
+    if (res != LV_RES_OK) return;
+
+    lv_event_code_t code = lv_event_get_code(e);
+    lv_obj_t * obj = lv_event_get_target(e);
+
+    if (code == LV_EVENT_DRAW_MAIN_END) {
+        lv_waterfall_t  *waterfall = (lv_waterfall_t *) obj;
+        lv_img_dsc_t    *dsc = waterfall->dsc;
+        lv_draw_ctx_t   *draw_ctx = lv_event_get_draw_ctx(e);
+
+        if (!dsc) return;
+
+        lv_area_t clip_area;
+
+        if (!_lv_area_intersect(&clip_area, draw_ctx->clip_area, &obj->coords)) return;
+
+        const lv_area_t *clip_area_ori = draw_ctx->clip_area;
+
+        draw_ctx->clip_area = &clip_area;
+
+        lv_draw_img_dsc_t   img_dsc;
+
+        lv_draw_img_dsc_init(&img_dsc);
+
+        lv_coord_t  w = dsc->header.w;
+        lv_coord_t  h = dsc->header.h;
+        lv_coord_t  x1 = obj->coords.x1 + (lv_obj_get_width(obj) - w) / 2;
+        lv_coord_t  y1 = obj->coords.y1 + (lv_obj_get_height(obj) - h) / 2;
+
+        /*
+         * The ring starts at line_top, so it is at least two blits. Lines painted
+         * before a scroll are drawn shifted, each run of equal offsets in one blit
+         */
+
+        lv_coord_t y = 0;
+
+        while (y < h) {
+            uint16_t    line = (waterfall->line_top + y) % h;
+            int32_t     line_offset = waterfall->line_offset[line];
+            lv_coord_t  n = 1;
+
+            while (y + n < h && line + n < h && waterfall->line_offset[line + n] == line_offset) {
+                n++;
+            }
+
+            int32_t     dx = waterfall->offset - line_offset;
+            lv_area_t   area;
+
+            area.x1 = x1 - dx;
+            area.x2 = area.x1 + w - 1;
+            area.y1 = y1 + y;
+            area.y2 = area.y1 + n - 1;
+
+            if (abs(dx) < w && area.y2 >= clip_area.y1 && area.y1 <= clip_area.y2) {
+                lv_draw_img_decoded(draw_ctx, &img_dsc, &area, dsc->data + line * waterfall->line_len, LV_IMG_CF_TRUE_COLOR);
+            }
+
+            y += n;
+        }
+
+        draw_ctx->clip_area = clip_area_ori;
+    }
 }
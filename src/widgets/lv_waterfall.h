@@ -24,11 +24,11 @@ extern "C" {
 typedef struct {
     lv_obj_t        obj;
 
-    lv_obj_t        *img;
     lv_img_dsc_t    *dsc;
 
     uint32_t        line_len;
-    uint8_t         *line_buf;
+    uint16_t        line_top;
+    int32_t         *line_offset;
 
     lv_grad_dsc_t   grad;
     lv_color_t      *palette;
@@ -38,6 +38,7 @@ typedef struct {
     int32_t         span;
     int16_t         scroll_surplus;
     int32_t         scroll;
+    int32_t         offset;
 } lv_waterfall_t;
 
 extern const lv_obj_class_t lv_waterfall_class;
@@ -0,0 +1,99 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ *
+ *  Block AGC against the per-sample one it replaced, one minute of bursts and
+ *  noise at the RX rate in ADC blocks. Output is expected to be bit exact
+ *
+ *  mkdir -p /tmp/agc_old
+ *  git show 2126312^:src/dsp/agc.c > /tmp/agc_old/agc.c
+ *  git show 2126312^:src/dsp/agc.h > /tmp/agc_old/agc.h
+ *  gcc -O3 -Isrc/dsp -DAGC_OLD='"/tmp/agc_old/agc.c"' -o bench_agc \
+ *      utils/bench/bench_agc.c utils/bench/bench_agc_old.c src/dsp/agc.c -lm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "agc.h"
+
+#define RATE    12800
+#define SIZE    (RATE * 60)
+#define BLOCK   128
+
+#define ARGS    AGC_FAST, RATE, 0.001f, 0.250f, 4, 100.0f, 1.5f, 4.0f, 1.0f, 1.0f, \
+                0.250f, 0.005f, 5.0f, 1, 0.500f, 0.250f, 0.250f, 0.100f
+
+void * old_agc_create(int mode, int sample_rate, float tau_attack, float tau_decay, int n_tau,
+    float max_gain, float var_gain, float fixed_gain, float max_input, float out_targ,
+    float tau_fast_backaverage, float tau_fast_decay, float pop_ratio, int hang_enable,
+    float tau_hang_backmult, float hangtime, float hang_thresh, float tau_hang_decay);
+
+float old_agc_apply(void *a, float in);
+void old_agc_set_mode(void *a, int mode);
+
+static float    in[SIZE];
+static float    out_old[SIZE];
+static float    out_new[SIZE];
+
+static double now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main() {
+    uint32_t seed = 1;
+
+    for (int i = 0; i < SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+
+        float noise = (((seed >> 8) & 0xFFFF) / 65536.0f - 0.5f) * 0.002f;
+        float level = 0.3f * (1 + (i / 20000) % 4) * ((i / 700) % 3 ? 1.0f : 0.01f);
+        float burst = (i / 3000) % 5 ? level * sinf(i * 0.31f) : 0.0f;
+
+        in[i] = noise + burst;
+    }
+
+    for (int mode = AGC_OFF; mode <= AGC_FAST; mode++) {
+        void    *old = old_agc_create(ARGS);
+        agc_t   *new = agc_create(ARGS);
+
+        old_agc_set_mode(old, mode);
+        agc_set_mode(new, mode);
+
+        double t0 = now();
+
+        for (int i = 0; i < SIZE; i++) {
+            out_old[i] = old_agc_apply(old, in[i]);
+        }
+
+        double t1 = now();
+
+        for (int i = 0; i < SIZE; i += BLOCK) {
+            agc_apply_block(new, in + i, out_new + i, BLOCK);
+        }
+
+        double t2 = now();
+        long differ = 0;
+
+        for (int i = 0; i < SIZE; i++) {
+            if (out_old[i] != out_new[i]) {
+                differ++;
+            }
+        }
+
+        printf("mode %i: per-sample %6.1f ms, block %6.1f ms, x%.2f, %li of %i samples differ\n",
+            mode, (t1 - t0) * 1e3, (t2 - t1) * 1e3, (t1 - t0) / (t2 - t1), differ, SIZE);
+    }
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ *
+ *  The per-sample AGC from before agc_apply_block, renamed to sit next to the
+ *  current one. See bench_agc.c
+ */
+
+#define agc_calc        old_agc_calc
+#define agc_decalc      old_agc_decalc
+#define agc_create      old_agc_create
+#define agc_destroy     old_agc_destroy
+#define agc_flush       old_agc_flush
+#define agc_set_mode    old_agc_set_mode
+#define agc_apply       old_agc_apply
+
+#include AGC_OLD
@@ -0,0 +1,109 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ *
+ *  Power to dB kernel against libm log10f. The vector path is whatever db.c
+ *  picks for the target (NEON or SSE2), scalar is its fallback
+ *
+ *  gcc -O3 -o bench_db utils/bench/bench_db.c -lm
+ *  gcc -O3 -mfpu=neon -mfloat-abi=hard -o bench_db utils/bench/bench_db.c -lm      (Cortex-A9)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "../../src/dsp/db.c"
+
+#define SIZE    4096
+#define ROUNDS  2000
+#define OFFSET  -85.0f
+#define FLOOR   -200.0f
+
+static float    power[SIZE];
+static float    out[SIZE];
+static double   ref[SIZE];
+static volatile size_t size = SIZE;    /* Keeps the call a real call */
+
+static double now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double max_error() {
+    double max = 0.0;
+
+    for (int i = 0; i < SIZE; i++) {
+        double e = fabs(out[i] - ref[i]);
+
+        if (e > max) {
+            max = e;
+        }
+    }
+
+    return max;
+}
+
+static void report(const char *name, double time, double base) {
+    printf("%-8s %7.2f ns/bin  x%5.2f  max error %.2e dB\n",
+        name, time * 1e9 / ((double) SIZE * ROUNDS), base / time, max_error());
+}
+
+int main() {
+    srand(1);
+
+    /* FFT powers span many decades */
+
+    for (int i = 0; i < SIZE; i++) {
+        power[i] = powf(10.0f, (rand() / (float) RAND_MAX) * 16.0f - 12.0f);
+        ref[i] = 10.0 * log10((double) power[i]) + OFFSET;
+    }
+
+    double t0 = now();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < SIZE; i++) {
+            out[i] = 10.0f * log10f(power[i]) + OFFSET;
+        }
+        __asm__ volatile("" ::: "memory");
+    }
+
+    double libm = now() - t0;
+
+    report("log10f", libm, libm);
+
+    t0 = now();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < SIZE; i++) {
+            out[i] = db_scalar(power[i], OFFSET, FLOOR);
+        }
+        __asm__ volatile("" ::: "memory");
+    }
+
+    report("scalar", now() - t0, libm);
+
+    t0 = now();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        db_from_power(power, out, size, OFFSET, FLOOR);
+        __asm__ volatile("" ::: "memory");
+    }
+
+#if defined(__ARM_NEON)
+    report("neon", now() - t0, libm);
+#elif defined(__SSE2__)
+    report("sse2", now() - t0, libm);
+#else
+    report("array", now() - t0, libm);
+#endif
+
+    return 0;
+}
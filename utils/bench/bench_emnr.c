@@ -0,0 +1,152 @@
+/*
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ *  TRX Brass LVGL GUI
+ *
+ *  Copyright (c) 2022-2025 Belousov Oleg aka R1CBU
+ *
+ *  EMNR in double (as before fftw3f) against the current single precision one.
+ *  Both are built from this file, run on the same 20 s of tone bursts in noise
+ *  and compared afterwards. Run on the radio for the timings that matter
+ *
+ *  mkdir -p /tmp/emnr_double
+ *  for f in emnr.c emnr.h calculus.c; do
+ *      git show 272e851^:src/dsp/$f > /tmp/emnr_double/$f
+ *  done
+ *  gcc -O3 -I/tmp/emnr_double -Isrc/dsp -o bench_emnr_double utils/bench/bench_emnr.c \
+ *      /tmp/emnr_double/emnr.c /tmp/emnr_double/calculus.c src/dsp/zeta_hat.c src/dsp/log10_fast.c -lfftw3 -lm
+ *  gcc -O3 -I. -Isrc/dsp -o bench_emnr_float utils/bench/bench_emnr.c \
+ *      src/dsp/emnr.c src/dsp/calculus.c src/dsp/zeta_hat.c src/dsp/log10_fast.c -lfftw3f -lpthread -lm
+ *
+ *  ./bench_emnr_double run /tmp/emnr_d
+ *  ./bench_emnr_float run /tmp/emnr_f
+ *  ./bench_emnr_float cmp /tmp/emnr_d /tmp/emnr_f
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include "emnr.h"
+
+#define RATE        12800
+#define BLOCK       32
+#define SECONDS     20
+#define SIZE        (RATE * SECONDS)
+#define METHODS     4
+
+static float    in[BLOCK];
+static float    out[BLOCK];
+static float    res[SIZE];
+static float    ref[SIZE];
+
+static double elapsed(const struct timespec *t0, const struct timespec *t1) {
+    return (t1->tv_sec - t0->tv_sec) + (t1->tv_nsec - t0->tv_nsec) * 1e-9;
+}
+
+static int run(const char *prefix) {
+    for (int method = 0; method < METHODS; method++) {
+        emnr_t          *emnr = emnr_create(BLOCK, in, out, 512, 8, RATE, 0, 1.0, method, EMNR_NPE_OSMS, 1);
+        uint32_t        seed = 1;
+        double          busy = 0.0;
+        struct timespec t0, t1;
+
+        for (int n = 0; n < SIZE; n += BLOCK) {
+            for (int i = 0; i < BLOCK; i++) {
+                seed = seed * 1103515245 + 12345;
+
+                float noise = ((seed >> 8) & 0xFFFF) / 65536.0f - 0.5f;
+                float gate = ((n + i) / (RATE / 2)) & 1 ? 1.0f : 0.0f;
+
+                in[i] = 0.05f * noise + gate * 0.3f * sinf(2.0f * M_PI * 700.0f * (n + i) / RATE);
+            }
+
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            emnr_apply(emnr);
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+
+            busy += elapsed(&t0, &t1);
+            memcpy(&res[n], out, sizeof(out));
+        }
+
+        char    name[256];
+        FILE    *f;
+
+        snprintf(name, sizeof(name), "%s%i.raw", prefix, method);
+        f = fopen(name, "wb");
+
+        if (!f) {
+            perror(name);
+            return 1;
+        }
+
+        fwrite(res, sizeof(float), SIZE, f);
+        fclose(f);
+
+        printf("gain method %i: %.3f s for %i s of audio, %.2f%% of real time\n",
+            method, busy, SECONDS, busy * 100.0 / SECONDS);
+    }
+
+    return 0;
+}
+
+static int load(const char *prefix, int method, float *data) {
+    char    name[256];
+    FILE    *f;
+
+    snprintf(name, sizeof(name), "%s%i.raw", prefix, method);
+    f = fopen(name, "rb");
+
+    if (!f) {
+        perror(name);
+        return 0;
+    }
+
+    size_t n = fread(data, sizeof(float), SIZE, f);
+
+    fclose(f);
+
+    return n == SIZE;
+}
+
+static int cmp(const char *prefix_ref, const char *prefix) {
+    for (int method = 0; method < METHODS; method++) {
+        if (!load(prefix_ref, method, ref) || !load(prefix, method, res)) {
+            return 1;
+        }
+
+        double signal = 0.0, error = 0.0, max = 0.0;
+
+        for (int i = 0; i < SIZE; i++) {
+            double d = fabs(res[i] - ref[i]);
+
+            signal += ref[i] * ref[i];
+            error += d * d;
+
+            if (d > max) {
+                max = d;
+            }
+        }
+
+        printf("gain method %i: SNR %.1f dB, max difference %.2e\n", method, 10.0 * log10(signal / error), max);
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 3 && strcmp(argv[1], "run") == 0) {
+        return run(argv[2]);
+    }
+
+    if (argc == 4 && strcmp(argv[1], "cmp") == 0) {
+        return cmp(argv[2], argv[3]);
+    }
+
+    fprintf(stderr, "%s run <prefix> | cmp <reference prefix> <prefix>\n", argv[0]);
+
+    return 1;
+}